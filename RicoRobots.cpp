@@ -1,7 +1,7 @@
 /** ---------------------------------------------
 * RicoRobots.cpp
-*      This version stores moves on a linked list, allowing
-*      infinite undo back to the beginning of the game.
+*      This version keeps a log of the moves made, allowing
+*      infinite undo back to the beginning of the game, and redo.
 
 * Board display looks like:
 
@@ -48,77 +48,260 @@
 #include <iostream>    // for cin and cout
 #include <cstring>     // for getline
 #include <cstdlib>     // for the system command
+#include <cstdio>      // for sprintf when building screen frames
 #include <cctype>      // For the letter checking functions, e.g. toupper( )
 #include <fstream>     // For file input and output
+#include <algorithm>   // For reverse( )
+#include <vector>      // For the solver's state arrays
+#include <memory>      // For unique_ptr
+#include <atomic>      // For the parallel solver's lock-free visited set
+#include <thread>      // For the parallel solver's worker threads
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>      // For batch mode input and output lines
+#include <sstream>
+#include <chrono>      // For timing each batch puzzle
+#include <map>         // For the board packs open in batch mode
+#include <unordered_set>   // For the puzzle generator's duplicate check
+#include <unordered_map>   // For the solution cache's memory tier
+#include <list>
+#include <queue>       // For merging the external solver's sorted files
+#include <sys/stat.h>  // For board pack file sizes and times
+#if !defined( _WIN32)
+#include <sys/mman.h>  // For memory-mapping board packs
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>  // For peak memory in the benchmarks and solver statistics
+#include <sys/socket.h>    // For server mode
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <csignal>
+#include <cerrno>
+#else
+#include <process.h>   // For _getpid(), naming the external solver's files
+#endif
+#include <stdint.h>    // For the fixed-width packed solver state keys and bitboards
+#include <type_traits> // For choosing the state key type
+#if defined( __AVX2__)
+#include <immintrin.h> // For the AVX2 successor kernel
+#elif defined( __SSE2__) || defined( _M_X64)
+#include <emmintrin.h> // For the SSE2 successor kernel
+#endif
+#if defined( _MSC_VER)
+#include <intrin.h>    // For the bit scan functions
+#endif
 using namespace std;
 
+// Game configuration
+//      The board size and number of robots are fixed when the program is compiled, so
+//      every loop over squares or robots has constant bounds.  The standard game is a
+//      16x16 board with 4 robots.  Build with, for instance,
+//          -DROBOT_COUNT=5             for the 5 robot game (a black or silver robot)
+//          -DBOARD_EDGE_LENGTH=8       for an 8x8 training board
+//      The edge must divide 64 (4, 8 or 16), so a row never crosses a bitboard word.
+//      Each robot takes 8 bits of a state key, so the key is 32 bits for up to 4 robots
+//      and 64 bits for 5 to 7.  Other builds read their board from a file named for
+//      the configuration, such as board16x16r5.txt, instead of board.txt.
+//
+#ifndef BOARD_EDGE_LENGTH
+#define BOARD_EDGE_LENGTH 16
+#endif
+#ifndef ROBOT_COUNT
+#define ROBOT_COUNT 4
+#endif
+
+template< int EDGE, int ROBOTS>
+struct GameConfig {
+    static_assert( (EDGE >= 4) && (EDGE <= 16) && ((64 % EDGE) == 0), "board edge must be 4, 8 or 16");
+    static_assert( (ROBOTS >= 2) && (ROBOTS <= 7), "there must be 2 to 7 robots");
+    static const int BOARD_EDGE = EDGE;
+    static const int BOARD_SIZE = EDGE * EDGE;
+    static const int NUMBER_OF_ROBOTS = ROBOTS;
+    static const int BITBOARD_WORDS = (BOARD_SIZE + 63) / 64;
+    typedef typename conditional< (8 * ROBOTS <= 32), uint32_t, uint64_t>::type StateKey;
+};
+typedef GameConfig< BOARD_EDGE_LENGTH, ROBOT_COUNT> Config;      // the game this program plays
+
+#define STRINGIZE_VALUE( x) #x
+#define STRINGIZE( x) STRINGIZE_VALUE( x)
+#if (BOARD_EDGE_LENGTH == 16) && (ROBOT_COUNT == 4)
+#define BOARD_FILE_BASE "board"
+#else
+#define BOARD_FILE_BASE "board" STRINGIZE( BOARD_EDGE_LENGTH) "x" STRINGIZE( BOARD_EDGE_LENGTH) "r" STRINGIZE( ROBOT_COUNT)
+#endif
+const char BOARD_FILE[] = BOARD_FILE_BASE ".txt";       // board read by the game and solver modes
+
 // Global data structure for board
-const int BOARD_EDGE = 16;
-const int BOARD_SIZE = BOARD_EDGE * BOARD_EDGE;
-// theBoard itself is represented by a one-dimensional array. 
-// The other entries are used to keep track of walls.  Each row
-// in theBoard array will contain the character to be displayed,
-// followed by any "walls" to be displayed around the displayed
-// character.  For instance the first couple of entries are be:
-//
-//      PIECE  LEFT ABOVE RIGHT BELOW
-//      ---0---  --1-  --2-  --3-  --4-
-//    0    .      |    _           
-//    1    .            _
-//  ...
-//  255  .                  |    _
-//
-char theBoard[ BOARD_SIZE][ 5];        // global array of board display characters
-// declare constants to later use instead of numbers to select values from theBoard
-const int PIECE = 0;    // to reference the character, such as in: theBoard[ i][ PIECE]
-const int LEFT = 1;     // to reference the left wall character, such as in: theBoard[ i][ left]
-const int ABOVE = 2;    // to reference the above wall character, such as in: theBoard[ i][ above]
-const int RIGHT = 3;    // to reference the right wall character, such as in: theBoard[ i][ right]
-const int BELOW = 4;    // to reference the below wall character, such as in: theBoard[ i][ below]
-
-// declare the 4 robots, which will store the board position of where they are found
-// Robots are displayed using values 1-4.  We declare 5 robots, though we will never use
-// the 0th robot in the array.
-const int NUMBER_OF_ROBOTS = 4;
-int theRobots[ NUMBER_OF_ROBOTS + 1] = {0,0,0,0,0};
-
-// Declare node structure for linked list
-struct Node {
-      char theBoard[ BOARD_SIZE][ 5];        // copy of array of board display characters
-      int theRobots[ NUMBER_OF_ROBOTS + 1];  // copy of robots locations
-      int moveNumber;                        // copy of move number
-      Node *pNext;                          // pointer to next node
-};
-
-//-------------------------------------------------------------------------------------
-// createBoard() - Create the board, initializing all the display characters
+const int BOARD_EDGE = Config::BOARD_EDGE;
+const int BOARD_SIZE = Config::BOARD_SIZE;
+
+// Directions a robot can move, in the order that playGame() lists them.  These are
+// also used to select the wall mask for one side of the squares, as in theBoard.walls[ LEFT]
+const int NUMBER_OF_DIRECTIONS = 4;
+const int LEFT = 0;
+const int ABOVE = 1;
+const int RIGHT = 2;
+const int BELOW = 3;
+const char DIRECTION_LETTERS[ NUMBER_OF_DIRECTIONS] = { 'L', 'U', 'R', 'D'};
+const int DIRECTION_OFFSETS[ NUMBER_OF_DIRECTIONS] = { -1, -BOARD_EDGE, 1, BOARD_EDGE};
+const int OPPOSITE_DIRECTION[ NUMBER_OF_DIRECTIONS] = { RIGHT, BELOW, LEFT, ABOVE};
+
+// A Bitboard is a set of board squares, one bit per square.  Square i is bit (i % 64)
+// of word[ i / 64], so each 64-bit word holds whole rows of the board (4 rows of the
+// standard board).  Bits past the last square are unused.
+const int BITBOARD_WORDS = Config::BITBOARD_WORDS;
+struct alignas( 32) Bitboard {
+    uint64_t word[ BITBOARD_WORDS];
+};
+
+// theBoard holds everything about the board that does not change during a game.
+// Walls are stored as one bitboard per side of the square.  A bit is set in
+// walls[ LEFT] if a robot on that square can not move left, whether the wall was
+// given on that square or as a right wall on its neighbor.  The board edges are walls.
+//
+//      walls[ LEFT]   walls[ ABOVE]   walls[ RIGHT]   walls[ BELOW]   (BOARD_SIZE bits each)
+//
+// slideStop is filled in by compileBoard(), and targets gives the square holding
+// each destination letter.  Robots are kept separately, in theRobots and theOccupancy.
+const int NUMBER_OF_LETTERS = 26;
+struct Board {
+    Bitboard walls[ NUMBER_OF_DIRECTIONS];                        // blocked sides of each square
+    unsigned char slideStop[ BOARD_SIZE][ NUMBER_OF_DIRECTIONS];  // where a lone robot stops
+    int targets[ NUMBER_OF_LETTERS];                              // square of 'A'..'Z', -1 if unused
+};
+Board theBoard;        // global board
+
+// declare the robots, which will store the board position of where they are found
+// Robots are displayed using values 1-4 (1-5 in the 5 robot game).  We declare one
+// extra robot, though we will never use the 0th robot in the array.
+const int NUMBER_OF_ROBOTS = Config::NUMBER_OF_ROBOTS;
+int theRobots[ NUMBER_OF_ROBOTS + 1] = {0};
+Bitboard theOccupancy;  // squares that currently have a robot on them
+
+// One move in the game history.  Walls never change during a game, so the robot and
+// the squares it moved between are enough to undo or redo the move.
+struct MoveRecord {
+      unsigned char robot;      // robot that moved, 1..NUMBER_OF_ROBOTS
+      unsigned char from;       // square it moved from
+      unsigned char to;         // square it stopped on
+};
+
+// History of the moves in a game.  The records are kept in one contiguous block, so
+// storing a move is a 3-byte append and undo or redo just moves one robot back or
+// forward.  Records at and after current are moves that were undone, kept for redo
+// until a new move is made.
+const int INITIAL_MOVE_LOG_CAPACITY = 1024;
+struct MoveLog {
+      vector<MoveRecord> records;   // every move made or undone, in order
+      size_t current;               // number of records currently applied
+
+      MoveLog() : current( 0) { records.reserve( INITIAL_MOVE_LOG_CAPACITY); }
+};
+
+
+//-------------------------------------------------------------------------------------
+// Bitboard operations
+//      Clear, set, reset and test one square, and find the lowest or highest set bit
+//      of a word.
+//
+inline void bitboardClear( Bitboard &bits)
+{
+    for( int i=0; i<BITBOARD_WORDS; i++) {
+        bits.word[ i] = 0;
+    }
+}
+
+inline void bitboardSet( Bitboard &bits, int square)
+{
+    bits.word[ square >> 6] |= (uint64_t)1 << (square & 63);
+}
+
+inline void bitboardReset( Bitboard &bits, int square)
+{
+    bits.word[ square >> 6] &= ~((uint64_t)1 << (square & 63));
+}
+
+inline bool bitboardTest( const Bitboard &bits, int square)
+{
+    return ((bits.word[ square >> 6] >> (square & 63)) & 1) != 0;
+}
+
+// Index of the lowest and highest set bit of a non-zero word
+inline int lowestBit( uint64_t word)
+{
+#if defined( _MSC_VER)
+    unsigned long index;
+    _BitScanForward64( &index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll( word);
+#endif
+}
+
+inline int highestBit( uint64_t word)
+{
+#if defined( _MSC_VER)
+    unsigned long index;
+    _BitScanReverse64( &index, word);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll( word);
+#endif
+}
+
+//-------------------------------------------------------------------------------------
+// addWall()
+//      Record a wall on one side of a square.  The neighbor on the other side of the
+//      wall gets the matching wall, so a move is blocked whichever square listed it.
+//
+void addWall( Board &board, int square, int direction)
+{
+    bitboardSet( board.walls[ direction], square);
+
+    // find the neighbor, unless the wall is on the edge of the board
+    int column = square % BOARD_EDGE;
+    if( ((direction == LEFT) && (column == 0)) ||
+        ((direction == RIGHT) && (column == BOARD_EDGE - 1)) ||
+        ((direction == ABOVE) && (square < BOARD_EDGE)) ||
+        ((direction == BELOW) && (square >= BOARD_SIZE - BOARD_EDGE))) {
+        return;
+    }
+    bitboardSet( board.walls[ OPPOSITE_DIRECTION[ direction]], square + DIRECTION_OFFSETS[ direction]);
+}
+
+
+//-------------------------------------------------------------------------------------
+// createBoard() - Create the board, with walls only around the edges
 //     
-void createBoard()
+void createBoard( Board &board)
 {
+    for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+        bitboardClear( board.walls[ direction]);
+    }
+    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+        board.targets[ letter] = -1;
+    }
+
     for( int i=0; i<BOARD_SIZE; i++) {
-        theBoard[ i][ PIECE]= '.';    // Set each playing piece default
-        // set the default wall values to be blank
-        theBoard[ i][ LEFT]= ' ';
-        theBoard[ i][ ABOVE]= ' '; 
-        theBoard[ i][ RIGHT]= ' '; 
-        theBoard[ i][ BELOW]=  ' ';
-
-        // reset the edge pieces
-        // reset the left wall if piece is on left edge
+        // set the left wall if piece is on left edge
         if( (i % BOARD_EDGE) == 0) {
-            theBoard[ i][ LEFT]= '|';       
+            addWall( board, i, LEFT);
         }
-        // reset the above wall if piece is on top edge
+        // set the above wall if piece is on top edge
         if( i < BOARD_EDGE) {
-            theBoard[ i][ ABOVE]= '-';       
+            addWall( board, i, ABOVE);
         }
-        // reset the right wall if piece is on right edge
+        // set the right wall if piece is on right edge
         if( ((i+1) % BOARD_EDGE) == 0) {
-            theBoard[ i][ RIGHT]= '|';       
+            addWall( board, i, RIGHT);
         }
-        // reset the below wall if piece is on bottom edge
+        // set the below wall if piece is on bottom edge
         if( i >= (BOARD_SIZE - BOARD_EDGE) ) {
-            theBoard[ i][ BELOW]= '-';       
+            addWall( board, i, BELOW);
         }
     }//end for( int i...
 
@@ -126,463 +309,7034 @@ void createBoard()
 
 
 //-------------------------------------------------------------------------------------
-// readFromFileAndModifyBoard() - Read from data file, updating board accordingly
-//         
-void readFromFileAndModifyBoard(int &numberOfDestinationPieces)
+// compileBoard()
+//      Fill in the board's slideStop table from its walls.  Call this once the board
+//      has been read, before any moves are made.
+//
+void compileBoard( Board &board)
+{
+    for( int square=0; square<BOARD_SIZE; square++) {
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            int position = square;
+            while( !bitboardTest( board.walls[ direction], position)) {
+                position += DIRECTION_OFFSETS[ direction];
+            }
+            board.slideStop[ square][ direction] = (unsigned char)position;
+        }
+    }
+}//end compileBoard()
+
+
+//-------------------------------------------------------------------------------------
+// readBoard() - Read one board definition, in the board.txt format, from a stream
+//      The board is created from scratch and then modified by the definition.  Returns
+//      false if the definition is cut short or puts something off the board.
+//
+bool readBoard( istream &inStream,                        // stream positioned at the definition
+                Board &board,                             // returns the board, not yet compiled
+                int robots[ NUMBER_OF_ROBOTS + 1],        // returns the robot starting squares
+                int &numberOfDestinationPieces)           // returns the number of letters
 {
   int numberOfSpecialSquares;    // read from file, denotes number of pieces with some kind of wall
 
-  ifstream inStream;             // declare an input file stream
-  // open input file
-  inStream.open("board.txt");   // associate the actual file name with "inStream"
-  if ( inStream.fail() ) {
-      cout << "Input file opening failed.  Exiting...\n\n";
-      exit(-1);
-  }
+  createBoard( board);           // start with walls only around the edges
 
   // read from file
   inStream >> numberOfDestinationPieces;      // read how many destination pieces there are
   inStream >> numberOfSpecialSquares;        // number of square with walls around them somewhere
   int pieceNumber;                           // pieceNumber for each square defined in data file
   char left, above, right, below;            // variables to store possible walls indicators
-  char letterToDisplay[ 2];                  // array to store possible letter to be displayed
+  string restOfLine;                         // holds the possible letter to be displayed
 
   // process the special squares, updating the board
   for( int i=0; i<numberOfSpecialSquares; i++) {
         // read the piece number
         inStream >> pieceNumber;
+        if( inStream.fail() || (pieceNumber < 0) || (pieceNumber >= BOARD_SIZE)) {
+            return false;
+        }
         // read the information on whether or not there is each of the potential 4 walls
         inStream >> left >> above >> right >> below;
         // store the corresponding walls
         if( left=='1') {
-            theBoard[ pieceNumber][ LEFT] = '|';
+            addWall( board, pieceNumber, LEFT);
         }   
         if( above=='1') {
-            theBoard[ pieceNumber][ ABOVE] = '-';
+            addWall( board, pieceNumber, ABOVE);
         }
         if( right=='1') {
-            theBoard[ pieceNumber][ RIGHT] = '|';
+            addWall( board, pieceNumber, RIGHT);
         }
         if( below=='1') {
-            theBoard[ pieceNumber][ BELOW] = '-';
+            addWall( board, pieceNumber, BELOW);
         }
-        // read either nothing else on the line, or the space and the letter to be displayed
-        inStream.getline( letterToDisplay, '\n');
-        if( strlen( letterToDisplay) > 0) {
-            // place the input character on the board if there was one
-            theBoard[ pieceNumber][ PIECE] = letterToDisplay[ 1];   
+        // read either nothing else on the line, or spaces and the letter to be displayed
+        getline( inStream, restOfLine);
+        size_t letterColumn = restOfLine.find_first_not_of( " \t\r");
+        if( (letterColumn != string::npos) && isalpha( restOfLine[ letterColumn])) {
+            // record which square holds the letter if there was one
+            board.targets[ toupper( restOfLine[ letterColumn]) - 'A'] = pieceNumber;
         }
   }//end for( int i... 
 
-  // process the 4 robots, updating the board
-  char junk[80];          // used to read and discard input file information
+  // process the robots, updating the board
   // Loop starts counting from 1 (rather than 0), since we ignore the 0th position
   // of the robots array, so that robot numbers correspond to what is shown
   // on the board.
+  robots[ 0] = 0;
   for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
-        inStream >> theRobots[ i];
-        inStream.getline( junk, '\n');    // discard rest of line
-        // set robot on board, converting the integer value to a character
-        theBoard[ theRobots[ i]][ PIECE] = (char)('0'+i);    // record the robot number in place on board
+        inStream >> robots[ i];
+        getline( inStream, restOfLine);    // discard rest of line
+        if( inStream.fail() || (robots[ i] < 0) || (robots[ i] >= BOARD_SIZE)) {
+            return false;
+        }
+        for( int j=1; j<i; j++) {
+            if( robots[ j] == robots[ i]) {
+                return false;      // two robots on one square
+            }
+        }
   }
 
-  inStream.close();        // close the input file stream 
-
-}//end readFromFileAndModifyBoard()
+  return true;
+}//end readBoard()
 
 
 //-------------------------------------------------------------------------------------
-// chooseRandomRobotAndDestination() - choose a robot at random, and a destination at random
+// Compiled board images
+//      A board image is a compiled Board, with its robot starting squares, stored as
+//      raw bytes so it can be used straight from a memory-mapped file with no parsing.
+//      A file (a "board pack") holds a header followed by one record per board:
 //
-void chooseRandomRobotAndDestination(
-                          int &goalRobot,        // returns the robot to use
-                          char &goalDestination,  // returns the destination square
-                          int numberOfDestinationPieces) // # of possible destinations
-{
-    int randomNumber = rand()%4;    // get random number from 0 to 3
-    goalRobot = randomNumber + 1;  // set random robot to be some value between 1 - 4 
+//          BoardImageHeader     magic "RRBI", version, record size, number of boards,
+//                               board edge and number of robots
+//          BoardRecord 0        compiled Board, robots and number of letters
+//          BoardRecord 1 ...
+//
+//      Records are in the byte order and layout of the machine that wrote them.  The
+//      magic number, version, record size and configuration in the header reject a file
+//      written by a different layout or game configuration, so bump BOARD_IMAGE_VERSION
+//      whenever Board changes.
+//
+//      RicoRobots -compile writes packs, BOARD_FILE is cached in BOARD_CACHE_FILE, and
+//      batch mode reads boards from packs with its "pack" command.
+//
+const uint32_t BOARD_IMAGE_MAGIC = 0x49425252;     // "RRBI" in a little-endian file
+const uint32_t BOARD_IMAGE_VERSION = 2;
+const char BOARD_CACHE_FILE[] = BOARD_FILE_BASE ".rrb";   // compiled copy of BOARD_FILE
 
-    // get random number from 0 to numberOfDestinationPieces
-    randomNumber = rand() % numberOfDestinationPieces; 
-    // add this number to 'A' to set the destination character
-    goalDestination = 'A' + randomNumber;                                                                       
-}// end chooseRandomRobotAndDestination()
+// Aligned so the records after it keep the alignment Bitboard needs
+struct alignas( 32) BoardImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;       // sizeof( BoardRecord)
+    uint32_t boardCount;
+    uint32_t boardEdge;        // BOARD_EDGE of the program that wrote it
+    uint32_t numberOfRobots;   // NUMBER_OF_ROBOTS of the program that wrote it
+};
+
+struct BoardRecord {
+    Board board;                                   // compiled board
+    int32_t robots[ NUMBER_OF_ROBOTS + 1];         // starting squares, theRobots layout
+    int32_t numberOfDestinationPieces;             // as read from the board definition
+};
 
 
 //-------------------------------------------------------------------------------------
-// displayBoard()  - Display the Board
+// boardRecordValid()
+//      Check a record from a file before it is used: the board edges must be walls,
+//      and letters and robots must be on the board.  The slide tables need no check,
+//      since every byte value is a square.
 //
-int displayBoard( int goalRobot,            // robot that needs to reach destination
-                  char destinationLetter,    // the destination letter
-                  char theBoard[ BOARD_SIZE][ 5])  // the board to be displayed
+bool boardRecordValid( const BoardRecord &record)
 {
-    // display robot to be moved and destination square
-    cout << "Move robot " << goalRobot << " to square " << destinationLetter << endl;
-
-    // display the top edge
-    cout << '|';  // display the leading edge
     for( int i=0; i<BOARD_EDGE; i++) {
-        cout << theBoard[ i][ ABOVE];
-        // only display the space if it is not at the end of the row
-        if( i < (BOARD_EDGE - 1) ) {
-            cout << " ";   
+        if( !bitboardTest( record.board.walls[ ABOVE], i) ||
+            !bitboardTest( record.board.walls[ BELOW], BOARD_SIZE - BOARD_EDGE + i) ||
+            !bitboardTest( record.board.walls[ LEFT], i * BOARD_EDGE) ||
+            !bitboardTest( record.board.walls[ RIGHT], i * BOARD_EDGE + BOARD_EDGE - 1)) {
+            return false;
         }
     }
-    cout << "|" << endl;      // display trailing edge
-
-    // display the "body" of the board
-    for( int i=0; i<BOARD_SIZE; i++) {
-        // Figure out what character should be displayed to the left.  It will
-        // be a wall if the current spot has a left wall, or if the spot to the
-        // left has a right wall.
-        char leftCharacter = theBoard[ i][ LEFT];  // set left display char
-        // See if the piece to the left has a right wall.  Don't do this for the
-        // first piece on the board, since it has no left neighbor.
-        if ( (i>0) && (theBoard[ i-1][ RIGHT] != ' ')) {
-              leftCharacter = theBoard[ i-1][ RIGHT];
-        }
-        cout << leftCharacter << theBoard[ i][ PIECE];
-        // see if we're at the end of a row
-        if( ((i+1) % BOARD_EDGE) == 0) {
-            // we are at the end of a row, so display right wall and go to next line
-            cout << theBoard[ i][ RIGHT] << endl;
-            // Now display any walls immediately below the line of pieces just displayed
-            // Backup our index counter j to the beginning of this line again, to find any
-            // walls displayed below this line
-            cout << "|";      // display the left boundary
-            for( int j=i-BOARD_EDGE+1; j<(i+1); j++) {
-                  // Set the character to be displayed.  This is a wall if the
-                  // current spot has a wall below, or if the spot below has a wall
-                  // above. 
-                  char belowCharacter = theBoard[ j][ BELOW];
-                  // Only check the square below if we're NOT on the bottom row
-                  if ( (j<(BOARD_SIZE - BOARD_EDGE)) &&      // verify not on bottom row
-                      (theBoard[ j+16][ ABOVE] != ' ')) {    // piece below has wall above 
-                      belowCharacter = theBoard[ j+16][ ABOVE];
-                  }
-                  cout << belowCharacter;        // display the character
-                  // display an extra space, if we're not at the end of a row
-                  if( ((j+1) % BOARD_EDGE) != 0) {
-                      cout << " ";       
-                  }
-            }
-            cout << "|" << endl;      // display the right boundary
-        }//end if( ((i+1...
-
-    }//end for( int i=0;...
-
-    cout << endl;
-
-}//end displayTheBoard()
+    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+        if( (record.board.targets[ letter] < -1) || (record.board.targets[ letter] >= BOARD_SIZE)) {
+            return false;
+        }
+    }
+    if( (record.numberOfDestinationPieces < 1) || (record.numberOfDestinationPieces > NUMBER_OF_LETTERS)) {
+        return false;
+    }
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        if( (record.robots[ i] < 0) || (record.robots[ i] >= BOARD_SIZE)) {
+            return false;
+        }
+        for( int j=1; j<i; j++) {
+            if( record.robots[ j] == record.robots[ i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}//end boardRecordValid()
 
 
 //-------------------------------------------------------------------------------------
-// canMove( )
-//      See if the robot can move in the desired direction
+// makeBoardRecord()
+//      Read one board definition, in the board.txt format, and compile it into a
+//      record.  Returns false if the definition is not valid.
 //
-bool canMove( int theRobot, int directionOffset, char moveDirection)
+bool makeBoardRecord( istream &inStream, BoardRecord &record)
 {
-    // find neighbor location
-    int theNeighbor = theRobot + directionOffset; 
-
-    // verify that we're not out-of-bounds before we use robot position to check board array
-    if( (theNeighbor < 0) || (theNeighbor >= BOARD_SIZE)) {
-        return false;    // attempting to move out of bounds, which is invalid   
-    }   
-
-    // See if we can move in the desired direction of travel.  For each direction we must check for
-    //      1. a wall in the piece we are moving from
-    //      2. a wall in the piece we are moving to
-    // If any wall is found, return false.
-    switch( moveDirection) {
-        case 'L':  if( (theBoard[ theRobot][ LEFT] != ' ') ||
-                      (theBoard[ theNeighbor][ RIGHT] != ' ')
-                    )
-                    return false;  // we can't make the move
-                    break;
-        case 'U':  if( (theBoard[ theRobot][ ABOVE] != ' ') ||
-                      (theBoard[ theNeighbor][ BELOW] != ' ')
-                    )
-                    return false;  // we can't make the move
-                    break; 
-        case 'R':  if( (theBoard[ theRobot][ RIGHT] != ' ') ||
-                      (theBoard[ theNeighbor][ LEFT] != ' ')
-                    )
-                    return false;  // we can't make the move
-                    break; 
-        case 'D':  if( (theBoard[ theRobot][ BELOW] != ' ') ||
-                      (theBoard[ theNeighbor][ ABOVE] != ' ')
-                    )
-                    return false;  // we can't make the move
-                    break;   
-        default: cout << "*** Error, invalid check for neighbor in canMove(). Exiting...\n";
-                exit( -1);      // exit the program
-    }     
+    int robots[ NUMBER_OF_ROBOTS + 1];
+    int numberOfDestinationPieces;
 
-    // Verify that the neighbor in the direction of travel is not also the location of one of the other
-    // robots.
-    char neighborPiece = theBoard[ theNeighbor][ PIECE];      // Make copy of neighbor board piece
-    // ensure destination doesn't contain a robot character, which is '1'..'4'
-    // Convert NUMBER_OF_ROBOTS to a char by adding it to char '0'
-    if( (neighborPiece >= '1') && (neighborPiece <= NUMBER_OF_ROBOTS+'0')) {
-        return false;  // destination has another robot, so can't move there.
+    memset( &record, 0, sizeof( record));       // no stray bytes in files
+    if( !readBoard( inStream, record.board, robots, numberOfDestinationPieces)) {
+        return false;
     }
-
-    return true;      // passed all the tests, so move is valid     
-}//end method canMove()
+    compileBoard( record.board);
+    for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+        record.robots[ i] = robots[ i];
+    }
+    record.numberOfDestinationPieces = numberOfDestinationPieces;
+    return boardRecordValid( record);
+}//end makeBoardRecord()
 
 
 //-------------------------------------------------------------------------------------
-// blankOutSourcePosition( )
-//    Put the default character in the square we're moving from.
-//    One other check must be made.  If a robot (which shouldn't be the goal robot)
-//    is moving OFF of the goal square, we must re-display the goal square letter.
-void blankOutSourcePosition( int robotIndex, int goalPosition, char destinationLetter)
+// writeBoardPack()
+//      Write records to a board pack file.  The file is written under a temporary
+//      name and then renamed, so a reader never maps a partly written pack.  Returns
+//      false if the file can't be written.
+//
+bool writeBoardPack( const char *fileName, const vector< BoardRecord> &records)
 {
-    if( robotIndex != goalPosition) {
-        theBoard[ robotIndex][ PIECE] = '.';
+    BoardImageHeader header;
+    memset( &header, 0, sizeof( header));
+    header.magic = BOARD_IMAGE_MAGIC;
+    header.version = BOARD_IMAGE_VERSION;
+    header.recordSize = sizeof( BoardRecord);
+    header.boardCount = (uint32_t)records.size();
+    header.boardEdge = BOARD_EDGE;
+    header.numberOfRobots = NUMBER_OF_ROBOTS;
+
+    string temporaryName = string( fileName) + ".tmp";
+    ofstream outStream( temporaryName.c_str(), ios::binary | ios::trunc);
+    outStream.write( (const char *)&header, sizeof( header));
+    if( !records.empty()) {
+        outStream.write( (const char *)&records[ 0], records.size() * sizeof( BoardRecord));
     }
-    else {
-        theBoard[ robotIndex][ PIECE] = destinationLetter;   
+    outStream.close();
+    if( outStream.fail()) {
+        remove( temporaryName.c_str());
+        return false;
     }
-}
+    remove( fileName);          // rename() won't replace a file on Windows
+    return rename( temporaryName.c_str(), fileName) == 0;
+}//end writeBoardPack()
 
 
 //-------------------------------------------------------------------------------------
-// getGoalPosition()
-//      Find the index of the goal letter.  This is used to mark the position where the
-//      goal letter must be redisplayed in the case (probably rare) where a non-goal
-//      robot passes over the goal letter, blanking it out.
+// BoardPack
+//      A board pack file opened for reading.  On POSIX systems the file is memory
+//      mapped, so opening costs the same however many boards it holds, and a record
+//      is only read from disk when it is first used.  Elsewhere the records are read
+//      into memory in one call.
 //
-int getGoalPosition( char destinationLetter)
+class BoardPack {
+public:
+    BoardPack() : header( NULL), records( NULL), mappedSize( 0) {}
+    ~BoardPack();
+    bool open( const char *fileName);        // false if the file is missing or not a valid pack
+    void close();
+    uint32_t size() const { return header ? header->boardCount : 0; }
+    const BoardRecord *record( uint32_t index) const;   // NULL if out of range or invalid
+
+private:
+    BoardPack( const BoardPack &);           // not copyable
+    BoardPack &operator=( const BoardPack &);
+
+    const BoardImageHeader *header;
+    const BoardRecord *records;
+    size_t mappedSize;                       // 0 if the file was read instead of mapped
+    BoardImageHeader readHeader;             // copies used when the file is read
+    vector< BoardRecord> readRecords;
+};
+
+BoardPack::~BoardPack()
 {
-    for( int i=0; i<BOARD_SIZE; i++) {
-        if( theBoard[ i][ PIECE] == destinationLetter) {
-            // found the position where the destination letter is, so return it
-            return i;
-        }   
-    }//end for( int i...
+    close();
+}
 
-    // Should never have gotten here, so display error message
-    cout << "*** Error, destination letter position not found.  Exiting program...";
-    exit( -1);  // exit program
+void BoardPack::close()
+{
+#if !defined( _WIN32)
+    if( mappedSize > 0) {
+        munmap( (void *)header, mappedSize);
+    }
+#endif
+    header = NULL;
+    records = NULL;
+    mappedSize = 0;
+    readRecords.clear();
 }
 
+bool BoardPack::open( const char *fileName)
+{
+    close();
 
-//-------------------------------------------------------------------------------------
-// displayLinkedList()
-//    display some of the entries from linked list, for debugging.
-//
-void displayLinkedList( Node *pHead)
+    // the file must be exactly a header and the number of records it gives
+    struct stat fileStatus;
+    if( (stat( fileName, &fileStatus) != 0) || ((size_t)fileStatus.st_size < sizeof( BoardImageHeader))) {
+        return false;
+    }
+    size_t fileSize = (size_t)fileStatus.st_size;
+
+#if !defined( _WIN32)
+    int file = ::open( fileName, O_RDONLY);
+    if( file < 0) {
+        return false;
+    }
+    void *mapping = mmap( NULL, fileSize, PROT_READ, MAP_SHARED, file, 0);
+    ::close( file);             // the mapping stays valid
+    if( mapping == MAP_FAILED) {
+        return false;
+    }
+    header = (const BoardImageHeader *)mapping;
+    records = (const BoardRecord *)(header + 1);
+    mappedSize = fileSize;
+#else
+    ifstream inStream( fileName, ios::binary);
+    inStream.read( (char *)&readHeader, sizeof( readHeader));
+    if( inStream.fail()) {
+        return false;
+    }
+    header = &readHeader;
+    if( (header->recordSize == sizeof( BoardRecord)) &&
+        (fileSize == sizeof( BoardImageHeader) + (size_t)header->boardCount * sizeof( BoardRecord))) {
+        readRecords.resize( header->boardCount);
+        if( !readRecords.empty()) {
+            inStream.read( (char *)&readRecords[ 0], readRecords.size() * sizeof( BoardRecord));
+        }
+        records = readRecords.empty() ? NULL : &readRecords[ 0];
+    }
+#endif
+
+    if( (header->magic != BOARD_IMAGE_MAGIC) || (header->version != BOARD_IMAGE_VERSION) ||
+        (header->boardEdge != BOARD_EDGE) || (header->numberOfRobots != NUMBER_OF_ROBOTS) ||
+        (header->recordSize != sizeof( BoardRecord)) ||
+        (fileSize != sizeof( BoardImageHeader) + (size_t)header->boardCount * sizeof( BoardRecord))) {
+        close();
+        return false;
+    }
+    return true;
+}//end BoardPack::open()
+
+const BoardRecord *BoardPack::record( uint32_t index) const
 {
-    cout << "------------" << endl;
-    // traverse list, displaying some contents from each node as we go
-    while( pHead != NULL) {
-            cout << "Robots 2 is at: " << pHead->theRobots[ 2] << " at move " << pHead->moveNumber << endl;
-            cout << "*** Debugging, board is: " << endl;
-            displayBoard( 2, 'M', pHead->theBoard);
-            pHead = pHead->pNext;     
+    if( (index >= size()) || !boardRecordValid( records[ index])) {
+        return NULL;
     }
-    cout << "------------" << endl << endl;   
+    return &records[ index];
 }
 
 
 //-------------------------------------------------------------------------------------
-// storeMoveOnList
-//      Store the current board and robot positions at the front of the linked list
+// readFromFileAndModifyBoard() - Read from data file, updating board accordingly
+//      The compiled board is cached in BOARD_CACHE_FILE.  If the cache is newer than
+//      board.txt it is loaded instead, with no parsing or compiling; otherwise
+//      board.txt is read and the cache is written again.
 //
-void storeMoveOnList( Node * &pHead,      // head of list, Reference parm so changes are reflected back
-                      int moveNumber)    // used to store current move number on the list
+void readFromFileAndModifyBoard(int &numberOfDestinationPieces)
 {
-    Node *pOldHead = pHead;  // store old head of the list, since we are changing it
-                              // but need new node to point to it.
+  const BoardRecord *record = NULL;
+  BoardPack cache;
+  BoardRecord newRecord;
 
-    pHead = new Node;        // allocate a new blank node
-    pHead->pNext = pOldHead;  // points to previous node on list (or NULL if list is empty the first time)
+  // use the cache if it is newer than board.txt
+  struct stat textStatus, cacheStatus;
+  if( (stat( BOARD_FILE, &textStatus) == 0) && (stat( BOARD_CACHE_FILE, &cacheStatus) == 0) &&
+      (cacheStatus.st_mtime > textStatus.st_mtime) && cache.open( BOARD_CACHE_FILE)) {
+      record = cache.record( 0);
+  }
 
-    // duplicate the board into the node's copy of the board
-    for( int i=0; i<BOARD_SIZE; i++) {
-          for( int j=0; j<5; j++) {
-              pHead->theBoard[i][j] = theBoard[i][j];     
-          }   
-    }
+  if( record == NULL) {
+      ifstream inStream;             // declare an input file stream
+      // open input file
+      inStream.open( BOARD_FILE);   // associate the actual file name with "inStream"
+      if ( inStream.fail() ) {
+          cout << "Input file opening failed.  Exiting...\n\n";
+          exit(-1);
+      }
 
-    // duplicate the robots array into the node's copy of the robots array
-    for( int i=0; i<(NUMBER_OF_ROBOTS + 1); i++) {
-          pHead->theRobots[ i] = theRobots[ i]; 
-    }
+      // read and compile the board
+      if( !makeBoardRecord( inStream, newRecord)) {
+          cout << "Input file does not hold a valid board.  Exiting...\n\n";
+          exit(-1);
+      }
+      inStream.close();        // close the input file stream 
+      record = &newRecord;
 
-    // add the move number to the node
-    pHead->moveNumber = moveNumber;
+      // cache the compiled board for next time.  Not being able to is not an error.
+      writeBoardPack( BOARD_CACHE_FILE, vector< BoardRecord>( 1, newRecord));
+  }
+
+  // copy the board, and put the robots in place on the occupancy mask
+  theBoard = record->board;
+  numberOfDestinationPieces = record->numberOfDestinationPieces;
+  bitboardClear( theOccupancy);
+  for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        theRobots[ i] = record->robots[ i];
+        bitboardSet( theOccupancy, theRobots[ i]);    // record the robot in place on board
+  }
 
-}//end storeMoveOnList
+}//end readFromFileAndModifyBoard()
 
 
 //-------------------------------------------------------------------------------------
-//  undoMove( )
-//    If there is more than 1 node on the list, remove the front-most node and
-//    make the board and the robot locations look like the following node on the list,
-//    which represents the previous move.
+// compileBoardPack()
+//      RicoRobots -compile pack.rrb board1.txt [board2.txt ...]
+//      Compile every board definition in the text files into one board pack.  A text
+//      file may hold several definitions one after the other.  Returns the exit status.
 //
-void undoMove( Node * &pHead,            // head of list, gets changed and returned
-              int &moveNumber)          // move number, which gets decremented
-{         
-    // head node should always exist when we get here.  Perform sanity check
-    if( pHead == NULL) {
-        cout << "Error in program, pHead is NULL.  Exiting..." << endl;   
+int compileBoardPack( const char *packName, char *textNames[], int textCount)
+{
+    vector< BoardRecord> records;
+    for( int i=0; i<textCount; i++) {
+        ifstream inStream( textNames[ i]);
+        if( inStream.fail()) {
+            cout << "Board file " << textNames[ i] << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        while( !(inStream >> ws).eof()) {
+            BoardRecord record;
+            if( !makeBoardRecord( inStream, record)) {
+                cout << "Board " << (records.size() + 1) << ", in " << textNames[ i]
+                     << ", is not a valid board.  Exiting..." << endl;
+                return -1;
+            }
+            records.push_back( record);
+        }
+    }
+    if( !writeBoardPack( packName, records)) {
+        cout << "Board pack " << packName << " could not be written.  Exiting..." << endl;
+        return -1;
     }
-    // verify that there is in fact a next move to use in the undo
-    if( pHead->pNext != NULL) {
-        // undo the move by removing the front node from the list, and restoring theBoard
-        // and theRobots from the list.
-        Node *pOldHead = pHead;      // store old head of list so we can free up the memory later
-        pHead = pHead->pNext;        // advance the head pointer on the list, to retrieve its values
+    cout << "Wrote " << records.size() << " boards to " << packName << endl;
+    return 0;
+}//end compileBoardPack()
 
-        // extract the board and robot values from the node, reflecting the previous move
-        for( int i=0; i<BOARD_SIZE; i++) {
-              for( int j=0; j<5; j++) {
-                  theBoard[i][j] = pHead->theBoard[i][j];   
-              }   
-        }
-        // extract the robots array from the node's copy of the previous move robots array
-        for( int i=0; i<(NUMBER_OF_ROBOTS + 1); i++) {
-              theRobots[ i] = pHead->theRobots[ i]; 
-        }       
 
-        // extract the move number from the one stored for this node
-        moveNumber = pHead->moveNumber;
+//-------------------------------------------------------------------------------------
+// Quadrants
+//      The physical board is four double-sided tiles, each a quarter of the board, so
+//      the same tiles make many layouts.  A quadrant file defines every tile side once
+//      and the robots once, and RicoRobots -assemble writes every layout to a board
+//      pack.  The file is
+//
+//          8                   number of quadrants
+//          1 A 9               tile, side, and number of special squares of the first
+//          0 0 0 1 0           special squares as in board.txt, numbered 0 to
+//          ...                 QUADRANT_SIZE-1 across the quadrant
+//          2 A 11              the next quadrant, and so on
+//          ...
+//          12                  robot starting squares on the whole board, one per line,
+//          ...                 as at the end of board.txt
+//
+//      Each quadrant is given as it lies in the top left of the board, with the board's
+//      center at its bottom right corner.  In the other positions it is turned, a
+//      quarter turn clockwise for each position clockwise from the top left.
+//
+//      When a quadrant is read it is placed in each position at once, as a Board of
+//      its own: its walls, with the matching walls of neighbors and the board edges,
+//      its letters, and slideStop for its squares, stopping at the edge of the
+//      quadrant.  Assembling a layout then ORs four sets of walls together and takes
+//      each slide from the quadrant it starts in, carried on through the next
+//      quadrant when it only stopped at the quadrant's edge.  A slide crosses the
+//      middle of the board at most once, so that next quadrant's slideStop is final.
+//
+const int QUADRANT_EDGE = BOARD_EDGE / 2;
+const int QUADRANT_SIZE = QUADRANT_EDGE * QUADRANT_EDGE;
+const int QUADRANT_POSITIONS = 4;            // top left, top right, bottom right, bottom left
+
+struct Quadrant {
+    int tile;                                // tiles are numbered from 1
+    char side;                               // side of the tile, 'A' or 'B'
+    Board placed[ QUADRANT_POSITIONS];       // the quadrant turned into each position
+};
 
-        free( pOldHead);            // free up the memory from the old head of list node
-    }       
-}//end undoMove()
+// One layout: the quadrant in each position, as numbers in the list read
+struct QuadrantLayout {
+    int quadrant[ QUADRANT_POSITIONS];
+};
 
 
 //-------------------------------------------------------------------------------------
-// playGame() - allow user to make moves, until they quit or reach the goal
+// quadrantPosition() and turnSquare()
+//      The position of the quadrant a square is in, and the square a quarter turn
+//      clockwise around the center of the board takes it to, turns times over.
 //
-void playGame( int goalRobot,            // robot that needs to reach destination
-              char destinationLetter)    // the destination letter
+inline int quadrantPosition( int square)
 {
-    int moveNumber = 1;          // track how many moves have been made
-    char robot = ' ';            // user entry for robot to move
-    char moveDirection = ' ';    // direction in which to move (L, U, R, or D)
-    int robotIndex = 0;          // location of key robot
-    int directionOffset = 0;    // value to add to current robot position to reflect move direction
-    bool undoErrorFlag = false;  // Used to mark situation when undo is chosen when there is no
-                                  //      stored move to which we can undo.
-    Node *pHead = NULL;          // initialize head of list pointer.  Very important to initialize this!
-
-    // Find which square has the goal letter in it. Store this to use in redisplaying the goal letter
-    // if a non-goal robot passes over it.
-    int goalPosition = getGoalPosition( destinationLetter); 
+    bool top = (square / BOARD_EDGE) < QUADRANT_EDGE;
+    bool left = (square % BOARD_EDGE) < QUADRANT_EDGE;
+    return top ? (left ? 0 : 1) : (left ? 3 : 2);
+}
 
-    // blank out all the letters except the destination letter, to make playing
-    // the game more clear
-    for( int i=0; i<BOARD_SIZE; i++) {
-          // Clear off the alphabetic squares, except for the destination square
-          //      isalpha is one of the char functions.  There are more such functions at
-          //      http://logos.cs.uic.edu/Examples And Notes/misc/CStdLib.html
-          if( isalpha( theBoard[ i][ PIECE]) && (theBoard[ i][ PIECE] != destinationLetter) ) {
-              theBoard[ i][ PIECE] = '.';      // set it to the default character
-          }   
+inline int turnSquare( int square, int turns)
+{
+    for( int i=0; i<turns; i++) {
+        square = (square % BOARD_EDGE) * BOARD_EDGE + (BOARD_EDGE - 1 - square / BOARD_EDGE);
     }
-    // display board
-    displayBoard( goalRobot, destinationLetter, theBoard);
+    return square;
+}
 
-    // create the initial node on the list, containing the blank board
-    storeMoveOnList( pHead, moveNumber);
 
-    // infinite loop to play the game
-    while( true) {
-        cout << moveNumber << ". Please enter the robot to move and the direction (e.g. 2 r): ";
-        // handle input of robot, (or 'X' to exit, or 'U' to undo)
-        cin >> robot;
-        if( toupper( robot) == 'X') {
-            break;      // exit program   
-        }
-        // Handle undoing a move.  Extra code is included so that the error message
-        // displayed when attempting undo at the beginning of the game gets displayed
-        // after the board, not before the board.
-        if( toupper( robot) == 'U') {
-            // Record if there is no history, to use in displaying message after attempting undo move
-            if( pHead->pNext == NULL) {
-                undoErrorFlag = true;  // there is no history, remember this
+//-------------------------------------------------------------------------------------
+// placeQuadrant()
+//      Fill in a quadrant's placed boards from the quadrant in the top left of base.
+//      A quarter turn clockwise turns a left wall into an above wall, and so on, so
+//      direction d becomes d + 1.
+//
+void placeQuadrant( Quadrant &quadrant, const Board &base)
+{
+    for( int position=0; position<QUADRANT_POSITIONS; position++) {
+        Board &placed = quadrant.placed[ position];
+        createBoard( placed);
+        memset( placed.slideStop, 0, sizeof( placed.slideStop));
+        for( int square=0; square<BOARD_SIZE; square++) {
+            if( quadrantPosition( square) != 0) {
+                continue;
             }
-
-            // Undo the move.             
-            undoMove( pHead, moveNumber);
-            system("cls");  // "cls" for unix
-            displayBoard( goalRobot, destinationLetter, theBoard);
-
-            // Display error message if there is no history to use in undo
-            if ( undoErrorFlag) {
-                  cout << "*** Can't undo past the beginning of the game.  Please retry move. " << endl << endl;
-                  undoErrorFlag = false;      // reset for use again next time
+            for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+                if( bitboardTest( base.walls[ direction], square)) {
+                    addWall( placed, turnSquare( square, position), (direction + position) % NUMBER_OF_DIRECTIONS);
+                }
             }
-            continue;    // go back up and prompt for next move
         }
-        cin >> moveDirection;
-        moveDirection = toupper( moveDirection);  // fold into upper-case
-        // ensure robot values were in range
-        if( (robot < '1') || (robot > NUMBER_OF_ROBOTS+'0')) {
-            cout << "Invalid robot value, please retry." << endl;
-            continue;  // continue up to the user input loop again   
+        for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+            if( (base.targets[ letter] >= 0) && (quadrantPosition( base.targets[ letter]) == 0)) {
+                placed.targets[ letter] = turnSquare( base.targets[ letter], position);
+            }
         }
 
-        // Find the directionOffset for robot change in position
-        switch( moveDirection) {
-            case 'L': directionOffset = -1; break;
-            case 'U': directionOffset = -BOARD_EDGE; break;
-            case 'R': directionOffset = 1; break;
-            case 'D': directionOffset = BOARD_EDGE; break;
-            default: cout << "*** Error, invalid direction.  Retry Input. \n" << endl;
-                continue;  // continue up to the user input loop again
-        } 
-
-        // Now move the piece in that direction, keeping on going until an obstacle is hit
-        // Send the current robot location as well as direction offset.
-        while( canMove( theRobots[ robot-'0'], directionOffset, moveDirection)) {
-
-            // Find position of robot
-            robotIndex = theRobots[ robot-'0'];
-            // blank out where robot is moving from
-            blankOutSourcePosition( robotIndex, goalPosition, destinationLetter);
-            // clear screen
-            system("cls");  // "cls" for unix
-
-            // store robot in new location
-            theBoard[ robotIndex + directionOffset][ PIECE] = robot;
-            // update robot index position.  Must subtract '0' from robot since it's a char
-            theRobots[ robot-'0'] = robotIndex + directionOffset;
-
-            // display board
-            displayBoard( goalRobot, destinationLetter, theBoard);
-        }//end while( canMove...
+        // slides within the quadrant
+        for( int square=0; square<BOARD_SIZE; square++) {
+            if( quadrantPosition( square) != position) {
+                continue;
+            }
+            for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+                int stop = square;
+                while( !bitboardTest( placed.walls[ direction], stop) &&
+                       (quadrantPosition( stop + DIRECTION_OFFSETS[ direction]) == position)) {
+                    stop += DIRECTION_OFFSETS[ direction];
+                }
+                placed.slideStop[ square][ direction] = (unsigned char)stop;
+            }
+        }
+    }
+}//end placeQuadrant()
 
-        // Update number of moves
-        moveNumber++;
 
-        // Store new move on linked list
-        storeMoveOnList( pHead, moveNumber);
+//-------------------------------------------------------------------------------------
+// readQuadrants()
+//      Read a quadrant file and place every quadrant.  Returns false if the file is
+//      cut short, puts something off its quadrant, gives a tile side twice, or gives
+//      a letter twice in one quadrant.
+//
+bool readQuadrants( istream &inStream,                         // stream positioned at the file
+                    vector< Quadrant> &quadrants,              // returns the quadrants, placed
+                    int robots[ NUMBER_OF_ROBOTS + 1])         // returns the robot starting squares
+{
+    int numberOfQuadrants;
+    inStream >> numberOfQuadrants;
+    if( inStream.fail() || (numberOfQuadrants < 1)) {
+        return false;
+    }
+    quadrants.resize( numberOfQuadrants);
+    for( int i=0; i<numberOfQuadrants; i++) {
+        Quadrant &quadrant = quadrants[ i];
+        int numberOfSpecialSquares;
+        inStream >> quadrant.tile >> quadrant.side >> numberOfSpecialSquares;
+        quadrant.side = (char)toupper( quadrant.side);
+        if( inStream.fail() || (quadrant.tile < 1)) {
+            return false;
+        }
+        for( int j=0; j<i; j++) {
+            if( (quadrants[ j].tile == quadrant.tile) && (quadrants[ j].side == quadrant.side)) {
+                return false;
+            }
+        }
 
-        // See if we've arrived at destination.  We've arrived if the robot just moved
-        // was the goal robot, and it's location is the goal position
-        if( ((robot-'0') == goalRobot) && (theRobots[ robot-'0'] == goalPosition) ) {
-            cout << "Great Job!  You did it in only " << moveNumber << " moves." << endl;
-            break;        // break from endless loop making moves 
-        }                                                             
-    }//end while( true...
+        // the quadrant as given, in the top left of a board
+        Board base;
+        createBoard( base);
+        for( int j=0; j<numberOfSpecialSquares; j++) {
+            int pieceNumber;
+            char left, above, right, below;
+            string restOfLine;
+            inStream >> pieceNumber >> left >> above >> right >> below;
+            if( inStream.fail() || (pieceNumber < 0) || (pieceNumber >= QUADRANT_SIZE)) {
+                return false;
+            }
+            int square = (pieceNumber / QUADRANT_EDGE) * BOARD_EDGE + pieceNumber % QUADRANT_EDGE;
+            char sides[ NUMBER_OF_DIRECTIONS] = { left, above, right, below };
+            for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+                if( sides[ direction] == '1') {
+                    addWall( base, square, direction);
+                }
+            }
+            getline( inStream, restOfLine);
+            size_t letterColumn = restOfLine.find_first_not_of( " \t\r");
+            if( (letterColumn != string::npos) && isalpha( restOfLine[ letterColumn])) {
+                int letter = toupper( restOfLine[ letterColumn]) - 'A';
+                if( base.targets[ letter] >= 0) {
+                    return false;
+                }
+                base.targets[ letter] = square;
+            }
+        }
+        placeQuadrant( quadrant, base);
+    }
 
-}// end playGame()
+    robots[ 0] = 0;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        string restOfLine;
+        inStream >> robots[ i];
+        getline( inStream, restOfLine);    // discard rest of line
+        if( inStream.fail() || (robots[ i] < 0) || (robots[ i] >= BOARD_SIZE)) {
+            return false;
+        }
+        for( int j=1; j<i; j++) {
+            if( robots[ j] == robots[ i]) {
+                return false;      // two robots on one square
+            }
+        }
+    }
+    return true;
+}//end readQuadrants()
 
 
 //-------------------------------------------------------------------------------------
-// main() - main part of program, that drives everything else
+// quadrantsOfBoard()
+//      Cut a board into its four quadrants, tiles 1 to 4 clockwise from the top left,
+//      each with one side, 'A'.  Assembling them in that order gives the board back.
 //
-int main()
+void quadrantsOfBoard( const Board &board, vector< Quadrant> &quadrants)
 {
-    // variable declarations
-    int goalRobot;          // the robot that needs to reach the goal                                                     
+    quadrants.resize( QUADRANT_POSITIONS);
+    for( int position=0; position<QUADRANT_POSITIONS; position++) {
+        // turn the quadrant back to the top left
+        int turns = (QUADRANT_POSITIONS - position) % QUADRANT_POSITIONS;
+        Board base;
+        createBoard( base);
+        for( int square=0; square<BOARD_SIZE; square++) {
+            if( quadrantPosition( square) != position) {
+                continue;
+            }
+            for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+                if( bitboardTest( board.walls[ direction], square)) {
+                    addWall( base, turnSquare( square, turns), (direction + turns) % NUMBER_OF_DIRECTIONS);
+                }
+            }
+        }
+        for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+            if( (board.targets[ letter] >= 0) && (quadrantPosition( board.targets[ letter]) == position)) {
+                base.targets[ letter] = turnSquare( board.targets[ letter], turns);
+            }
+        }
+        quadrants[ position].tile = position + 1;
+        quadrants[ position].side = 'A';
+        placeQuadrant( quadrants[ position], base);
+    }
+}//end quadrantsOfBoard()
+
+
+//-------------------------------------------------------------------------------------
+// listQuadrantLayouts()
+//      List every layout of the quadrants: four different tiles, one side of each.  A
+//      layout turned a quarter turn is the same board turned, so only the layouts with
+//      their lowest numbered tile in the top left are listed.  Four double-sided tiles
+//      give 3! orders times 2^4 sides, 96 layouts.
+//
+void listQuadrantLayouts( const vector< Quadrant> &quadrants, vector< QuadrantLayout> &layouts)
+{
+    layouts.clear();
+    QuadrantLayout layout;
+    int position = 0;
+    layout.quadrant[ 0] = -1;
+    while( position >= 0) {
+        // try the next quadrant in this position
+        int &quadrant = layout.quadrant[ position];
+        bool fits = false;
+        while( !fits && (++quadrant < (int)quadrants.size())) {
+            fits = (position == 0) || (quadrants[ quadrant].tile > quadrants[ layout.quadrant[ 0]].tile);
+            for( int i=1; i<position; i++) {
+                fits = fits && (quadrants[ quadrant].tile != quadrants[ layout.quadrant[ i]].tile);
+            }
+        }
+        if( quadrant >= (int)quadrants.size()) {
+            position--;            // every quadrant has been tried here
+        }
+        else if( position == QUADRANT_POSITIONS - 1) {
+            layouts.push_back( layout);
+        }
+        else {
+            layout.quadrant[ ++position] = -1;
+        }
+    }
+}//end listQuadrantLayouts()
+
+
+//-------------------------------------------------------------------------------------
+// assembleLayout()
+//      Put together the compiled board of one layout from its placed quadrants.
+//      Returns false if two of the quadrants hold the same letter.
+//
+bool assembleLayout( const vector< Quadrant> &quadrants,
+                     const QuadrantLayout &layout,
+                     Board &board)                  // returns the compiled board
+{
+    const Board *placed[ QUADRANT_POSITIONS];
+    for( int position=0; position<QUADRANT_POSITIONS; position++) {
+        placed[ position] = &quadrants[ layout.quadrant[ position]].placed[ position];
+    }
+
+    for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+        for( int word=0; word<BITBOARD_WORDS; word++) {
+            board.walls[ direction].word[ word] = placed[ 0]->walls[ direction].word[ word] |
+                                                  placed[ 1]->walls[ direction].word[ word] |
+                                                  placed[ 2]->walls[ direction].word[ word] |
+                                                  placed[ 3]->walls[ direction].word[ word];
+        }
+    }
+    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+        board.targets[ letter] = -1;
+        for( int position=0; position<QUADRANT_POSITIONS; position++) {
+            if( placed[ position]->targets[ letter] >= 0) {
+                if( board.targets[ letter] >= 0) {
+                    return false;
+                }
+                board.targets[ letter] = placed[ position]->targets[ letter];
+            }
+        }
+    }
+
+    // the quadrant's own slides, then the ones toward the middle of the board that
+    // only stopped at the edge of the quadrant, not at a wall, carried on.  A slide
+    // that stopped at a wall is looked up again from where it stopped, which gives the
+    // same square, so there is no branch to mispredict.
+    for( int row=0; row<BOARD_EDGE; row++) {
+        const Board &left = *placed[ quadrantPosition( row * BOARD_EDGE)];
+        const Board &right = *placed[ quadrantPosition( row * BOARD_EDGE + BOARD_EDGE - 1)];
+        memcpy( board.slideStop[ row * BOARD_EDGE], left.slideStop[ row * BOARD_EDGE],
+                QUADRANT_EDGE * sizeof( board.slideStop[ 0]));
+        memcpy( board.slideStop[ row * BOARD_EDGE + QUADRANT_EDGE], right.slideStop[ row * BOARD_EDGE + QUADRANT_EDGE],
+                QUADRANT_EDGE * sizeof( board.slideStop[ 0]));
+    }
+    for( int square=0; square<BOARD_SIZE; square++) {
+        int inward[ 2] = { ((square % BOARD_EDGE) < QUADRANT_EDGE) ? RIGHT : LEFT,
+                           ((square / BOARD_EDGE) < QUADRANT_EDGE) ? BELOW : ABOVE };
+        for( int i=0; i<2; i++) {
+            int direction = inward[ i];
+            int stop = board.slideStop[ square][ direction];
+            int next = stop + (bitboardTest( board.walls[ direction], stop) ? 0 : DIRECTION_OFFSETS[ direction]);
+            board.slideStop[ square][ direction] = placed[ quadrantPosition( next)]->slideStop[ next][ direction];
+        }
+    }
+    return true;
+}//end assembleLayout()
+
+
+//-------------------------------------------------------------------------------------
+// assembleQuadrants()
+//      RicoRobots -assemble quadrants.txt pack.rrb
+//      Assemble every layout of the quadrants in the file into one board pack, and
+//      list which layout each board of the pack is.  Returns the exit status.
+//
+int assembleQuadrants( const char *quadrantName, const char *packName)
+{
+    ifstream inStream( quadrantName);
+    if( inStream.fail()) {
+        cout << "Quadrant file " << quadrantName << " could not be opened.  Exiting..." << endl;
+        return -1;
+    }
+    vector< Quadrant> quadrants;
+    int robots[ NUMBER_OF_ROBOTS + 1];
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if( !readQuadrants( inStream, quadrants, robots)) {
+        cout << "Quadrant file " << quadrantName << " does not hold valid quadrants.  Exiting..." << endl;
+        return -1;
+    }
+    vector< QuadrantLayout> layouts;
+    listQuadrantLayouts( quadrants, layouts);
+    vector< BoardRecord> records( layouts.size());
+    for( size_t i=0; i<layouts.size(); i++) {
+        BoardRecord &record = records[ i];
+        memset( &record, 0, sizeof( record));       // no stray bytes in files
+        bool assembled = assembleLayout( quadrants, layouts[ i], record.board);
+        for( int robot=0; robot<=NUMBER_OF_ROBOTS; robot++) {
+            record.robots[ robot] = robots[ robot];
+        }
+        record.numberOfDestinationPieces = 0;
+        for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+            record.numberOfDestinationPieces += (record.board.targets[ letter] >= 0);
+        }
+        if( !assembled || !boardRecordValid( record)) {
+            cout << "Layout " << i << " has a letter twice, or none.  Exiting..." << endl;
+            return -1;
+        }
+    }
+    double milliseconds = chrono::duration< double, milli>( chrono::steady_clock::now() - start).count();
+
+    if( layouts.empty() || !writeBoardPack( packName, records)) {
+        cout << "Board pack " << packName << " could not be written.  Exiting..." << endl;
+        return -1;
+    }
+    for( size_t i=0; i<layouts.size(); i++) {
+        cout << i;
+        for( int position=0; position<QUADRANT_POSITIONS; position++) {
+            const Quadrant &quadrant = quadrants[ layouts[ i].quadrant[ position]];
+            cout << " " << quadrant.tile << quadrant.side;
+        }
+        cout << "\n";
+    }
+    cout << "Wrote " << layouts.size() << " layouts of " << quadrants.size() << " quadrants to " << packName
+         << ", read and assembled in " << milliseconds << " ms" << endl;
+    return 0;
+}//end assembleQuadrants()
+
+
+//-------------------------------------------------------------------------------------
+// chooseRandomRobotAndDestination() - choose a robot at random, and a destination at random
+//
+void chooseRandomRobotAndDestination(
+                          int &goalRobot,        // returns the robot to use
+                          char &goalDestination,  // returns the destination square
+                          int numberOfDestinationPieces) // # of possible destinations
+{
+    int randomNumber = rand()%4;    // get random number from 0 to 3
+    goalRobot = randomNumber + 1;  // set random robot to be some value between 1 - 4 
+
+    // get random number from 0 to numberOfDestinationPieces
+    randomNumber = rand() % numberOfDestinationPieces; 
+    // add this number to 'A' to set the destination character
+    goalDestination = 'A' + randomNumber;                                                                       
+}// end chooseRandomRobotAndDestination()
+
+
+//-------------------------------------------------------------------------------------
+// drawBoardImage()  - Draw the board as text
+//      The board is drawn into a fixed grid of characters: the title line, the top
+//      edge, then each row of pieces followed by the walls below it.  Walls come from
+//      the board's wall masks, and the only letter shown is the destination letter.
+//      Robots are drawn on top of it.  Unused cells are spaces.
+//
+const int BOARD_WIDTH = 2 * BOARD_EDGE + 1;     // characters across the board itself
+const int TITLE_WIDTH = 26;                     // characters in the title, with 2 digit robot numbers
+const int IMAGE_WIDTH = (BOARD_WIDTH > TITLE_WIDTH) ? BOARD_WIDTH : TITLE_WIDTH;   // characters in each line of the image
+const int IMAGE_LINES = 2 + 2 * BOARD_EDGE;     // title, top edge, and two lines per row
+
+void drawBoardImage( char image[ IMAGE_LINES][ IMAGE_WIDTH],   // the drawn board
+                     int goalRobot,            // robot that needs to reach destination
+                     char destinationLetter,    // the destination letter
+                     const Board &board,        // the board to be drawn
+                     const int robots[ NUMBER_OF_ROBOTS + 1])  // robot positions to draw
+{
+    // work out the character shown on each square
+    char pieces[ BOARD_SIZE];
+    for( int i=0; i<BOARD_SIZE; i++) {
+        pieces[ i] = '.';
+    }
+    if( isalpha( destinationLetter) && (board.targets[ toupper( destinationLetter) - 'A'] >= 0)) {
+        pieces[ board.targets[ toupper( destinationLetter) - 'A']] = destinationLetter;
+    }
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        pieces[ robots[ i]] = (char)('0' + i);
+    }
+
+    memset( image, ' ', IMAGE_LINES * IMAGE_WIDTH);
+
+    // robot to be moved and destination square
+    char title[ IMAGE_WIDTH + 1];
+    int titleLength = snprintf( title, sizeof( title), "Move robot %d to square %c", goalRobot, destinationLetter);
+    memcpy( image[ 0], title, min( titleLength, IMAGE_WIDTH));
+
+    // the top edge
+    char *line = image[ 1];
+    line[ 0] = '|';
+    for( int i=0; i<BOARD_EDGE; i++) {
+        line[ 1 + 2*i] = bitboardTest( board.walls[ ABOVE], i) ? '-' : ' ';
+    }
+    line[ BOARD_WIDTH - 1] = '|';
+
+    // each row of pieces, then the walls immediately below it.  The character to the
+    // left of a piece is a wall if the square can't be left to the left.  Walls given
+    // on either side are both in walls[ LEFT].
+    for( int row=0; row<BOARD_EDGE; row++) {
+        char *pieceLine = image[ 2 + 2*row];
+        char *wallLine = image[ 3 + 2*row];
+        wallLine[ 0] = '|';
+        for( int column=0; column<BOARD_EDGE; column++) {
+            int i = row * BOARD_EDGE + column;
+            pieceLine[ 2*column] = bitboardTest( board.walls[ LEFT], i) ? '|' : ' ';
+            pieceLine[ 2*column + 1] = pieces[ i];
+            wallLine[ 1 + 2*column] = bitboardTest( board.walls[ BELOW], i) ? '-' : ' ';
+        }
+        pieceLine[ BOARD_WIDTH - 1] = bitboardTest( board.walls[ RIGHT], row * BOARD_EDGE + BOARD_EDGE - 1) ? '|' : ' ';
+        wallLine[ BOARD_WIDTH - 1] = '|';
+    }
+}//end drawBoardImage()
+
+
+//-------------------------------------------------------------------------------------
+// appendImageLine()
+//      Copy one line of the board image to the end of a text buffer, without the
+//      trailing spaces, and end it with a newline.  Returns the new buffer length.
+//
+int appendImageLine( char *buffer, int length, const char line[ IMAGE_WIDTH])
+{
+    int lineLength = IMAGE_WIDTH;
+    while( (lineLength > 0) && (line[ lineLength - 1] == ' ')) {
+        lineLength--;
+    }
+    memcpy( buffer + length, line, lineLength);
+    length += lineLength;
+    buffer[ length++] = '\n';
+    return length;
+}
+
+
+//-------------------------------------------------------------------------------------
+// displayBoard()  - Display the Board
+//      The board is drawn into one buffer and written with a single call.
+//
+void displayBoard( int goalRobot,            // robot that needs to reach destination
+                   char destinationLetter,    // the destination letter
+                   const Board &board,        // the board to be displayed
+                   const int robots[ NUMBER_OF_ROBOTS + 1])  // robot positions to display
+{
+    char image[ IMAGE_LINES][ IMAGE_WIDTH];
+    char text[ IMAGE_LINES * (IMAGE_WIDTH + 1) + 1];
+    int length = 0;
+
+    drawBoardImage( image, goalRobot, destinationLetter, board, robots);
+    for( int i=0; i<IMAGE_LINES; i++) {
+        length = appendImageLine( text, length, image[ i]);
+    }
+    text[ length++] = '\n';      // blank line after the board
+
+    cout.write( text, length);
+    cout.flush();
+}//end displayTheBoard()
+
+
+//-------------------------------------------------------------------------------------
+// Renderer
+//      Redraws the board in place during a game using ANSI escape sequences.  The
+//      first frame clears the screen and draws the whole board.  After that only the
+//      cells that differ from what is on the screen are sent, each run of changed
+//      cells after one cursor positioning sequence.  Each frame is built in one
+//      preallocated buffer and written with a single call, and frames are spaced out
+//      to at most framesPerSecond.  With animate turned off, playGame() draws only
+//      the final position of each move.
+//
+const int DEFAULT_FRAMES_PER_SECOND = 30;
+// Room for a full redraw, or for every cell changing, each with its own cursor move
+const int FRAME_BUFFER_SIZE = IMAGE_LINES * IMAGE_WIDTH * 10 + 64;
+
+struct Renderer {
+      char frame[ FRAME_BUFFER_SIZE];            // the frame being built
+      char screen[ IMAGE_LINES][ IMAGE_WIDTH];   // board image currently on the screen
+      bool screenValid;              // false until the first frame clears the screen
+      bool animate;                  // show each square of a slide, or just the result
+      int framesPerSecond;           // frame rate cap, 0 for no cap
+      chrono::steady_clock::time_point lastFrame;   // when the last frame was written
+
+      Renderer() : screenValid( false), animate( true), framesPerSecond( DEFAULT_FRAMES_PER_SECOND) {}
+};
+
+
+//-------------------------------------------------------------------------------------
+// appendCursorMove()
+//      Append the escape sequence moving the cursor to a line and column, both counted
+//      from 1.  Returns the new buffer length.
+//
+int appendCursorMove( char *buffer, int length, int line, int column)
+{
+    return length + sprintf( buffer + length, "\x1b[%d;%dH", line, column);
+}
+
+
+//-------------------------------------------------------------------------------------
+// renderBoard()
+//      Draw the board on the screen, sending only the changes since the last frame.
+//      The cursor is left on the line after the blank line below the board, with the
+//      rest of the screen cleared, ready for the next prompt.
+//
+void renderBoard( Renderer &renderer,       // screen state, updated
+                  int goalRobot,            // robot that needs to reach destination
+                  char destinationLetter,    // the destination letter
+                  const Board &board,        // the board to be displayed
+                  const int robots[ NUMBER_OF_ROBOTS + 1])  // robot positions to display
+{
+    char image[ IMAGE_LINES][ IMAGE_WIDTH];
+    char *frame = renderer.frame;
+    int length = 0;
+
+    drawBoardImage( image, goalRobot, destinationLetter, board, robots);
+
+    if( !renderer.screenValid) {
+        // clear the screen and draw everything
+        length += sprintf( frame, "\x1b[2J\x1b[H");
+        for( int i=0; i<IMAGE_LINES; i++) {
+            length = appendImageLine( frame, length, image[ i]);
+        }
+        renderer.screenValid = true;
+    }
+    else {
+        // send each run of changed cells
+        for( int i=0; i<IMAGE_LINES; i++) {
+            bool inRun = false;
+            for( int j=0; j<IMAGE_WIDTH; j++) {
+                if( image[ i][ j] == renderer.screen[ i][ j]) {
+                    inRun = false;
+                    continue;
+                }
+                if( !inRun) {
+                    length = appendCursorMove( frame, length, i + 1, j + 1);
+                    inRun = true;
+                }
+                frame[ length++] = image[ i][ j];
+            }
+        }
+    }
+    memcpy( renderer.screen, image, sizeof( image));
+
+    // park the cursor below the board and clear old prompts and messages
+    length = appendCursorMove( frame, length, IMAGE_LINES + 2, 1);
+    length += sprintf( frame + length, "\x1b[J");
+
+    // wait out the rest of the frame time, then write the frame
+    if( renderer.framesPerSecond > 0) {
+        this_thread::sleep_until( renderer.lastFrame + chrono::microseconds( 1000000 / renderer.framesPerSecond));
+    }
+    cout.write( frame, length);
+    cout.flush();
+    renderer.lastFrame = chrono::steady_clock::now();
+}//end renderBoard()
+
+
+//-------------------------------------------------------------------------------------
+// canMove( )
+//      See if the robot can move one square in the desired direction.  This is the
+//      one-square move rule; playGame() now uses the tables built by compileBoard(),
+//      which apply the same wall checks.  The version without a board checks the
+//      global board and robots.
+//
+inline bool canMove( const Board &board,          // board walls
+                     const Bitboard &occupancy,   // squares that have a robot on them
+                     int theRobot, int directionOffset, char moveDirection)
+{
+    // find neighbor location
+    int theNeighbor = theRobot + directionOffset; 
+
+    // verify that we're not out-of-bounds before we use robot position to check board array
+    if( (theNeighbor < 0) || (theNeighbor >= BOARD_SIZE)) {
+        return false;    // attempting to move out of bounds, which is invalid   
+    }   
+
+    // See if there is a wall on the side of the square we are moving from.  Walls
+    // given on the square we are moving to are also recorded there by addWall().
+    int direction = 0;
+    switch( moveDirection) {
+        case 'L':  direction = LEFT; break;
+        case 'U':  direction = ABOVE; break;
+        case 'R':  direction = RIGHT; break;
+        case 'D':  direction = BELOW; break;
+        default: cout << "*** Error, invalid check for neighbor in canMove(). Exiting...\n";
+                exit( -1);      // exit the program
+    }
+    if( bitboardTest( board.walls[ direction], theRobot)) {
+        return false;  // we can't make the move
+    }     
+
+    // Verify that the neighbor in the direction of travel is not also the location of one of the other
+    // robots.
+    if( bitboardTest( occupancy, theNeighbor)) {
+        return false;  // destination has another robot, so can't move there.
+    }
+
+    return true;      // passed all the tests, so move is valid     
+}//end method canMove()
+
+bool canMove( int theRobot, int directionOffset, char moveDirection)
+{
+    return canMove( theBoard, theOccupancy, theRobot, directionOffset, moveDirection);
+}
+
+
+//-------------------------------------------------------------------------------------
+// getGoalPosition()
+//      Find the index of the goal letter.  This is used to check whether the goal
+//      robot has reached its destination.  With a board given, returns -1 if the
+//      letter isn't on it; the version for the global board exits instead.
+//
+int getGoalPosition( const Board &board, char destinationLetter)
+{
+    if( isalpha( destinationLetter) && (board.targets[ toupper( destinationLetter) - 'A'] >= 0)) {
+        // found the position where the destination letter is, so return it
+        return board.targets[ toupper( destinationLetter) - 'A'];
+    }
+    return -1;
+}
+
+int getGoalPosition( char destinationLetter)
+{
+    int goalPosition = getGoalPosition( theBoard, destinationLetter);
+    if( goalPosition >= 0) {
+        return goalPosition;
+    }
+
+    // Should never have gotten here, so display error message
+    cout << "*** Error, destination letter position not found.  Exiting program...";
+    exit( -1);  // exit program
+}
+
+
+//-------------------------------------------------------------------------------------
+// Packed robot states and slide-stop tables
+//      The position of all the robots is packed into one state key with 8 bits (one
+//      board square, 0..255) per robot.  Robot 1 is in the lowest byte.  The key is
+//      32 bits in the standard 4 robot game, see GameConfig.
+//
+//      compileBoard() precomputes, for every square and direction, where a robot
+//      stops when only walls are considered.  A single move is then one table lookup
+//      plus a check for other robots between the start and that square.
+//
+//      When every move from a state is needed, as in the solver, generateSuccessors()
+//      works out all of them at once, with SIMD where the build allows it.
+//
+typedef Config::StateKey StateKey;
+
+
+//-------------------------------------------------------------------------------------
+// packRobots()
+//      Pack the robot positions (theRobots layout, entries 1..NUMBER_OF_ROBOTS) into a state key
+//
+StateKey packRobots( const int robots[ NUMBER_OF_ROBOTS + 1])
+{
+    StateKey key = 0;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        key |= (StateKey)robots[ i] << (8 * (i-1));
+    }
+    return key;
+}
+
+
+//-------------------------------------------------------------------------------------
+// robotPosition()
+//      Extract the board position of one robot (1..NUMBER_OF_ROBOTS) from a state key
+//
+inline int robotPosition( StateKey key, int robot)
+{
+    return (int)(key >> (8 * (robot-1))) & 0xFF;
+}
+
+
+//-------------------------------------------------------------------------------------
+// hashSlot()
+//      Slot for a state key in a hash table of (mask + 1) entries.  Uses the high half
+//      of a 64-bit multiply, which depends on every robot in the key (robots past the
+//      fourth only reach the high half).  The low bits of
+//      a plain multiply would only depend on the first robot or two.
+//
+inline uint32_t hashSlot( StateKey key, uint32_t mask)
+{
+    return (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+
+//-------------------------------------------------------------------------------------
+// slideRobot()
+//      Return the square where the robot stops when moved in the given direction
+//      from the state given by key.  The wall stop comes from slideStop, and is then
+//      cut short by the nearest robot in the way.
+//
+inline int slideRobot( const Board &board, StateKey key, int robot, int direction)
+{
+    int from = robotPosition( key, robot);
+    int stop = board.slideStop[ from][ direction];
+    int offset = DIRECTION_OFFSETS[ direction];
+
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        int other = robotPosition( key, i);
+        // A robot is in the way if it is between from and stop, on the same row or
+        // column.  Sliding is along a row when offset is +-1, so only vertical moves
+        // need the column check.
+        bool inRange = (offset > 0) ? ((other > from) && (other <= stop))
+                                    : ((other < from) && (other >= stop));
+        if( inRange && (((other - from) % offset) == 0)) {
+            stop = other - offset;    // stop just in front of it
+        }
+    }
+    return stop;
+}//end slideRobot()
+
+
+//-------------------------------------------------------------------------------------
+// generateSuccessors()
+//      Fill in the states reachable in one move from key, with the move that reaches
+//      each one as (robot-1)*4 + direction.  Moves are listed robot 1, 2, ..., and for each
+//      robot in the order L, U, R, D.  Moves that leave the robot where it is are left
+//      out.  Returns the number of successors.  successors and moveCodes may be part
+//      of a larger buffer, such as the next frontier; all MAX_SUCCESSORS entries of
+//      each may be written, whatever the count.
+//
+//      All the moves are worked out at once, one lane per (robot, direction): the
+//      stop from slideStop, cut short by the nearest robot ahead on the same row or
+//      column.  Moves to lower squares (left and up) are flipped, square ^ 0xFF, so
+//      every lane looks for the lowest square ahead of it.  A robot on square q then
+//      cuts a lane short at q - step if it is on the lane's line and q > from; the
+//      robot itself never is.  With AVX2 and four robots the 16 lanes are one
+//      register, the four stop bytes of a square are one 32-bit gather, and the
+//      successors are packed down with a shuffle table.  Otherwise the same lanes are
+//      worked out in a loop.
+//
+const int MAX_SUCCESSORS = NUMBER_OF_ROBOTS * NUMBER_OF_DIRECTIONS;
+
+#if defined( __AVX2__) && (ROBOT_COUNT == 4)
+#define SUCCESSORS_AVX2 1
+#define SUCCESSORS_SSE2 0
+#elif (defined( __SSE2__) || defined( _M_X64)) && (ROBOT_COUNT == 4)
+#define SUCCESSORS_AVX2 0
+#define SUCCESSORS_SSE2 1
+#else
+#define SUCCESSORS_AVX2 0
+#define SUCCESSORS_SSE2 0
+#endif
+
+// For each direction: the flip of lower squares, the bits that must match for a square
+// to be on the same line (row bits for left and right, column bits for up and down),
+// and the distance between neighboring squares of the line
+const int LANE_FLIP[ NUMBER_OF_DIRECTIONS] = { 0xFF, 0xFF, 0, 0 };
+const int LANE_LINE_BITS[ NUMBER_OF_DIRECTIONS] = { 0xFF & ~(BOARD_EDGE - 1), BOARD_EDGE - 1,
+                                                    0xFF & ~(BOARD_EDGE - 1), BOARD_EDGE - 1 };
+const int LANE_STEP[ NUMBER_OF_DIRECTIONS] = { 1, BOARD_EDGE, 1, BOARD_EDGE };
+
+#if SUCCESSORS_AVX2
+// For each 8-bit mask, the numbers of its set bits in increasing order, one per byte:
+// the lanes to keep, for packing 8 lanes down with _mm256_permutevar8x32_epi32
+struct LanePackTable {
+    uint64_t lanes[ 256];
+    unsigned char count[ 256];        // number of lanes kept
+
+    LanePackTable()
+    {
+        for( int mask=0; mask<256; mask++) {
+            int kept = 0;
+            lanes[ mask] = 0;
+            for( int lane=0; lane<8; lane++) {
+                if( (mask >> lane) & 1) {
+                    lanes[ mask] |= (uint64_t)lane << (8 * kept++);
+                }
+            }
+            count[ mask] = (unsigned char)kept;
+        }
+    }
+};
+const LanePackTable LANE_PACK;
+#endif
+
+inline int generateSuccessors( const Board &board,                         // board walls
+                               StateKey key,                               // state to move from
+                               StateKey successors[ MAX_SUCCESSORS],       // returns the new states
+                               unsigned char moveCodes[ MAX_SUCCESSORS])   // returns the moves
+{
+#if SUCCESSORS_AVX2
+    // lane (robot-1)*4 + direction, 16 bits each
+    const __m256i flip = _mm256_setr_epi16( 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0);
+    const __m256i lineBits = _mm256_setr_epi16(
+        LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3],
+        LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3],
+        LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3],
+        LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3]);
+    const __m256i step = _mm256_setr_epi16( 1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE,
+                                            1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE);
+    __m128i keyBytes = _mm_cvtsi32_si128( (int)key);
+    __m256i from = _mm256_cvtepu8_epi16( _mm_shuffle_epi8( keyBytes,
+                       _mm_setr_epi8( 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3)));
+    __m128i wallStops = _mm_i32gather_epi32( (const int *)board.slideStop, _mm_cvtepu8_epi32( keyBytes), 4);
+    __m256i flippedFrom = _mm256_xor_si256( from, flip);
+    __m256i stop = _mm256_xor_si256( _mm256_cvtepu8_epi16( wallStops), flip);
+    for( int robot=0; robot<NUMBER_OF_ROBOTS; robot++) {
+        __m256i other = _mm256_set1_epi16( (short)((key >> (8 * robot)) & 0xFF));
+        __m256i onLine = _mm256_cmpeq_epi16( _mm256_and_si256( _mm256_xor_si256( other, from), lineBits),
+                                             _mm256_setzero_si256());
+        __m256i flippedOther = _mm256_xor_si256( other, flip);
+        __m256i ahead = _mm256_cmpgt_epi16( flippedOther, flippedFrom);
+        __m256i cut = _mm256_min_epi16( stop, _mm256_sub_epi16( flippedOther, step));
+        stop = _mm256_blendv_epi8( stop, cut, _mm256_and_si256( onLine, ahead));
+    }
+    __m256i to = _mm256_xor_si256( stop, flip);
+
+    // the new keys, 8 lanes at a time: robots 1 and 2, then robots 3 and 4
+    __m256i keys = _mm256_set1_epi32( (int)key);
+    __m256i low = _mm256_or_si256( _mm256_and_si256( keys, _mm256_setr_epi32( ~0xFF, ~0xFF, ~0xFF, ~0xFF,
+                                                                               ~0xFF00, ~0xFF00, ~0xFF00, ~0xFF00)),
+                                   _mm256_sllv_epi32( _mm256_cvtepu16_epi32( _mm256_castsi256_si128( to)),
+                                                      _mm256_setr_epi32( 0, 0, 0, 0, 8, 8, 8, 8)));
+    __m256i high = _mm256_or_si256( _mm256_and_si256( keys, _mm256_setr_epi32( ~0xFF0000, ~0xFF0000, ~0xFF0000, ~0xFF0000,
+                                                                                (int)~0xFF000000u, (int)~0xFF000000u,
+                                                                                (int)~0xFF000000u, (int)~0xFF000000u)),
+                                    _mm256_sllv_epi32( _mm256_cvtepu16_epi32( _mm256_extracti128_si256( to, 1)),
+                                                       _mm256_setr_epi32( 16, 16, 16, 16, 24, 24, 24, 24)));
+
+    // keep the lanes where the robot moved, packed down in order
+    __m256i stayed = _mm256_cmpeq_epi16( to, from);
+    int moved = ~_mm_movemask_epi8( _mm_packs_epi16( _mm256_castsi256_si128( stayed),
+                                                     _mm256_extracti128_si256( stayed, 1))) & 0xFFFF;
+    uint64_t lowLanes = LANE_PACK.lanes[ moved & 0xFF];
+    uint64_t highLanes = LANE_PACK.lanes[ moved >> 8];
+    int lowCount = LANE_PACK.count[ moved & 0xFF];
+    _mm256_storeu_si256( (__m256i *)successors,
+                         _mm256_permutevar8x32_epi32( low, _mm256_cvtepu8_epi32( _mm_cvtsi64_si128( (long long)lowLanes))));
+    _mm256_storeu_si256( (__m256i *)(successors + lowCount),
+                         _mm256_permutevar8x32_epi32( high, _mm256_cvtepu8_epi32( _mm_cvtsi64_si128( (long long)highLanes))));
+    highLanes += 0x0808080808080808ULL;          // lanes 8..15 are moves 8..15
+    memcpy( moveCodes, &lowLanes, sizeof( lowLanes));
+    memcpy( moveCodes + lowCount, &highLanes, sizeof( highLanes));
+    return lowCount + LANE_PACK.count[ moved >> 8];
+#elif SUCCESSORS_SSE2
+    // lanes (robot-1)*4 + direction as above, in two registers: robots 1 and 2, then 3 and 4
+    const __m128i flip = _mm_setr_epi16( 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0);
+    const __m128i lineBits = _mm_setr_epi16( LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3],
+                                             LANE_LINE_BITS[ 0], LANE_LINE_BITS[ 1], LANE_LINE_BITS[ 2], LANE_LINE_BITS[ 3]);
+    const __m128i step = _mm_setr_epi16( 1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE, 1, BOARD_EDGE);
+    __m128i keyBytes = _mm_cvtsi32_si128( (int)key);
+    __m128i positions = _mm_unpacklo_epi8( keyBytes, _mm_setzero_si128());         // robots 1..4 in 16 bits each
+    __m128i fromLow = _mm_unpacklo_epi64( _mm_shufflelo_epi16( positions, _MM_SHUFFLE( 0, 0, 0, 0)),
+                                          _mm_shufflelo_epi16( positions, _MM_SHUFFLE( 1, 1, 1, 1)));
+    __m128i fromHigh = _mm_unpacklo_epi64( _mm_shufflelo_epi16( positions, _MM_SHUFFLE( 2, 2, 2, 2)),
+                                           _mm_shufflelo_epi16( positions, _MM_SHUFFLE( 3, 3, 3, 3)));
+    uint32_t wallStops[ NUMBER_OF_ROBOTS];
+    for( int robot=0; robot<NUMBER_OF_ROBOTS; robot++) {
+        memcpy( &wallStops[ robot], board.slideStop[ robotPosition( key, robot + 1)], sizeof( wallStops[ robot]));
+    }
+    __m128i stopBytes = _mm_setr_epi32( (int)wallStops[ 0], (int)wallStops[ 1], (int)wallStops[ 2], (int)wallStops[ 3]);
+    __m128i stopLow = _mm_xor_si128( _mm_unpacklo_epi8( stopBytes, _mm_setzero_si128()), flip);
+    __m128i stopHigh = _mm_xor_si128( _mm_unpackhi_epi8( stopBytes, _mm_setzero_si128()), flip);
+    __m128i flippedLow = _mm_xor_si128( fromLow, flip);
+    __m128i flippedHigh = _mm_xor_si128( fromHigh, flip);
+    for( int robot=0; robot<NUMBER_OF_ROBOTS; robot++) {
+        __m128i other = _mm_set1_epi16( (short)robotPosition( key, robot + 1));
+        __m128i flippedOther = _mm_xor_si128( other, flip);
+        __m128i cutAt = _mm_sub_epi16( flippedOther, step);
+        __m128i cutsLow = _mm_and_si128( _mm_cmpeq_epi16( _mm_and_si128( _mm_xor_si128( other, fromLow), lineBits),
+                                                          _mm_setzero_si128()),
+                                         _mm_cmpgt_epi16( flippedOther, flippedLow));
+        __m128i cutsHigh = _mm_and_si128( _mm_cmpeq_epi16( _mm_and_si128( _mm_xor_si128( other, fromHigh), lineBits),
+                                                           _mm_setzero_si128()),
+                                          _mm_cmpgt_epi16( flippedOther, flippedHigh));
+        stopLow = _mm_or_si128( _mm_and_si128( cutsLow, _mm_min_epi16( stopLow, cutAt)), _mm_andnot_si128( cutsLow, stopLow));
+        stopHigh = _mm_or_si128( _mm_and_si128( cutsHigh, _mm_min_epi16( stopHigh, cutAt)), _mm_andnot_si128( cutsHigh, stopHigh));
+    }
+    __m128i toLow = _mm_xor_si128( stopLow, flip);
+    __m128i toHigh = _mm_xor_si128( stopHigh, flip);
+    int moved = ~_mm_movemask_epi8( _mm_packs_epi16( _mm_cmpeq_epi16( toLow, fromLow),
+                                                     _mm_cmpeq_epi16( toHigh, fromHigh))) & 0xFFFF;
+
+    // the stops fit in bytes: write out the lanes where the robot moved, in order
+    unsigned char to[ MAX_SUCCESSORS];
+    _mm_storeu_si128( (__m128i *)to, _mm_packus_epi16( toLow, toHigh));
+    int count = 0;
+    for( int robot=0; robot<NUMBER_OF_ROBOTS; robot++) {
+        StateKey others = key & ~((StateKey)0xFF << (8 * robot));
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            int lane = robot * NUMBER_OF_DIRECTIONS + direction;
+            successors[ count] = others | ((StateKey)to[ lane] << (8 * robot));
+            moveCodes[ count] = (unsigned char)lane;
+            count += (moved >> lane) & 1;
+        }
+    }
+    return count;
+#else
+    int from[ NUMBER_OF_ROBOTS];
+    for( int robot=0; robot<NUMBER_OF_ROBOTS; robot++) {
+        from[ robot] = robotPosition( key, robot + 1);
+    }
+    int count = 0;
+    for( int lane=0; lane<MAX_SUCCESSORS; lane++) {
+        int robot = lane / NUMBER_OF_DIRECTIONS;
+        int direction = lane % NUMBER_OF_DIRECTIONS;
+        int flip = LANE_FLIP[ direction];
+        int flippedFrom = from[ robot] ^ flip;
+        int stop = board.slideStop[ from[ robot]][ direction] ^ flip;
+        for( int other=0; other<NUMBER_OF_ROBOTS; other++) {
+            // no branches, the outcome is random
+            int flippedOther = from[ other] ^ flip;
+            bool cuts = (((from[ other] ^ from[ robot]) & LANE_LINE_BITS[ direction]) == 0) & (flippedOther > flippedFrom);
+            int cut = min( stop, flippedOther - LANE_STEP[ direction]);
+            stop = cuts ? cut : stop;
+        }
+        int to = stop ^ flip;
+        successors[ count] = (key & ~((StateKey)0xFF << (8 * robot))) | ((StateKey)to << (8 * robot));
+        moveCodes[ count] = (unsigned char)lane;
+        count += (to != from[ robot]);
+    }
+    return count;
+#endif
+}//end generateSuccessors()
+
+
+//-------------------------------------------------------------------------------------
+// generateSuccessorBatch()
+//      generateSuccessors() for each of count states, with all the successors written
+//      one after another straight into successors, such as the end of a frontier.
+//      parents gets the index in keys of the state each one came from.  The arrays
+//      need room for count * MAX_SUCCESSORS entries.  Returns the number written.
+//
+inline size_t generateSuccessorBatch( const Board &board,          // board walls
+                                      const StateKey *keys,        // states to move from
+                                      size_t count,
+                                      StateKey *successors,        // returns the new states
+                                      unsigned char *moveCodes,    // returns the moves
+                                      uint32_t *parents)           // returns the state each came from
+{
+    size_t total = 0;
+    for( size_t i=0; i<count; i++) {
+        for( int j=0; j<MAX_SUCCESSORS; j++) {
+            parents[ total + j] = (uint32_t)i;
+        }
+        total += generateSuccessors( board, keys[ i], successors + total, moveCodes + total);
+    }
+    return total;
+}
+
+
+//-------------------------------------------------------------------------------------
+// prefetch()
+//      Start loading the cache line holding address, for a hash table slot that will
+//      be probed soon
+//
+inline void prefetch( const void *address)
+{
+#if defined( _MSC_VER)
+    _mm_prefetch( (const char *)address, _MM_HINT_T0);
+#else
+    __builtin_prefetch( address);
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+// displayMoveLog()
+//    display the moves in the history, for debugging.
+//
+void displayMoveLog( const MoveLog &history)
+{
+    cout << "------------" << endl;
+    for( size_t i=0; i<history.records.size(); i++) {
+        const MoveRecord &record = history.records[ i];
+        cout << (i+1) << ". robot " << (int)record.robot << " from " << (int)record.from
+             << " to " << (int)record.to << ((i < history.current) ? "" : "  (undone)") << endl;
+    }
+    cout << "------------" << endl << endl;
+}
+
+
+//-------------------------------------------------------------------------------------
+// recordMove()
+//      Add a move to the end of the history.  Any undone moves can no longer be redone.
+//
+void recordMove( MoveLog &history,     // history of the game
+                 int robot,            // robot that moved, 1..NUMBER_OF_ROBOTS
+                 int from,             // square it moved from
+                 int to)               // square it stopped on
+{
+    history.records.resize( history.current);   // drop the moves kept for redo
+    MoveRecord record;
+    record.robot = (unsigned char)robot;
+    record.from = (unsigned char)from;
+    record.to = (unsigned char)to;
+    history.records.push_back( record);
+    history.current++;
+}//end recordMove()
+
+
+//-------------------------------------------------------------------------------------
+// moveRobotTo()
+//      Put a robot on a new square, keeping the robots array and occupancy mask in step
+//
+inline void moveRobotTo( int robots[ NUMBER_OF_ROBOTS + 1], Bitboard &occupancy, int robot, int square)
+{
+    bitboardReset( occupancy, robots[ robot]);
+    bitboardSet( occupancy, square);
+    robots[ robot] = square;
+}
+
+
+//-------------------------------------------------------------------------------------
+//  undoMove( ) and redoMove( )
+//    Take back the last move in the history, or make the last undone move again.
+//    Returns false if there is nothing to undo or redo.
+//
+bool undoMove( MoveLog &history,                       // history of the game
+               int robots[ NUMBER_OF_ROBOTS + 1],      // robot positions, updated
+               Bitboard &occupancy)                    // robot occupancy mask, updated
+{
+    if( history.current == 0) {
+        return false;      // at the beginning of the game
+    }
+    const MoveRecord &record = history.records[ --history.current];
+    moveRobotTo( robots, occupancy, record.robot, record.from);
+    return true;
+}//end undoMove()
+
+bool redoMove( MoveLog &history,                       // history of the game
+               int robots[ NUMBER_OF_ROBOTS + 1],      // robot positions, updated
+               Bitboard &occupancy)                    // robot occupancy mask, updated
+{
+    if( history.current == history.records.size()) {
+        return false;      // nothing has been undone
+    }
+    const MoveRecord &record = history.records[ history.current++];
+    moveRobotTo( robots, occupancy, record.robot, record.to);
+    return true;
+}//end redoMove()
+
+
+//-------------------------------------------------------------------------------------
+// Games
+//      A Game is one game in progress: the robots, the goal and the move history.
+//      The compiled board is shared, read-only, by every game played on it, so a
+//      process can hold thousands of games, and games can be advanced on different
+//      threads at once with no locking, as long as each game is used by one thread
+//      at a time.  Nothing here touches theBoard or theRobots.
+//
+struct Game {
+    shared_ptr< const Board> board;        // compiled board, shared with other games
+    int robots[ NUMBER_OF_ROBOTS + 1];     // robot positions, theRobots layout
+    Bitboard occupancy;                    // squares that have a robot on them
+    int goalRobot;                         // robot that needs to reach destination
+    char destinationLetter;                // the destination letter
+    int goalPosition;                      // square of the destination letter
+    MoveLog history;                       // moves made so far, for undo and redo
+
+    Game() : goalRobot( 0), destinationLetter( ' '), goalPosition( -1)
+    {
+        memset( robots, 0, sizeof( robots));
+        bitboardClear( occupancy);
+    }
+};
+
+
+//-------------------------------------------------------------------------------------
+// startGame()
+//      Set up a game on board, with the robots on the given squares.  Returns false,
+//      leaving the game unchanged, if the goal robot isn't 1..NUMBER_OF_ROBOTS or the
+//      letter isn't on the board.
+//
+bool startGame( Game &game,                                     // game to set up
+                const shared_ptr< const Board> &board,          // compiled board to play on
+                const int robots[ NUMBER_OF_ROBOTS + 1],        // starting squares, theRobots layout
+                int goalRobot,                                  // robot that needs to reach destination
+                char destinationLetter)                         // the destination letter
+{
+    int goalPosition = getGoalPosition( *board, destinationLetter);
+    if( (goalRobot < 1) || (goalRobot > NUMBER_OF_ROBOTS) || (goalPosition < 0)) {
+        return false;
+    }
+    game.board = board;
+    bitboardClear( game.occupancy);
+    game.robots[ 0] = 0;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        game.robots[ i] = robots[ i];
+        bitboardSet( game.occupancy, robots[ i]);
+    }
+    game.goalRobot = goalRobot;
+    game.destinationLetter = (char)toupper( destinationLetter);
+    game.goalPosition = goalPosition;
+    game.history.records.clear();
+    game.history.current = 0;
+    return true;
+}//end startGame()
+
+
+//-------------------------------------------------------------------------------------
+// makeGameMove(), undoGameMove(), redoGameMove() and goalReached()
+//      Move a robot (1..NUMBER_OF_ROBOTS) as far as it goes in a direction (LEFT,
+//      ABOVE, RIGHT or BELOW) and record it, returning the square it stopped on.
+//      Undo and redo return false if there is nothing to undo or redo.
+//
+int makeGameMove( Game &game, int robot, int direction)
+{
+    int destination = slideRobot( *game.board, packRobots( game.robots), robot, direction);
+    recordMove( game.history, robot, game.robots[ robot], destination);
+    moveRobotTo( game.robots, game.occupancy, robot, destination);
+    return destination;
+}
+
+bool undoGameMove( Game &game)
+{
+    return undoMove( game.history, game.robots, game.occupancy);
+}
+
+bool redoGameMove( Game &game)
+{
+    return redoMove( game.history, game.robots, game.occupancy);
+}
+
+inline bool goalReached( const Game &game)
+{
+    return game.robots[ game.goalRobot] == game.goalPosition;
+}
+
+// Number of moves made so far that moved their robot; a move into a wall changes nothing
+int gameMovesMade( const Game &game)
+{
+    int moveCount = 0;
+    for( size_t i=0; i<game.history.current; i++) {
+        moveCount += (game.history.records[ i].from != game.history.records[ i].to);
+    }
+    return moveCount;
+}
+
+
+//-------------------------------------------------------------------------------------
+// boardHash()
+//      64-bit FNV-1a hash of the parts of a compiled board that decide solutions: the
+//      walls and the letter squares.  slideStop follows from the walls.
+//
+uint64_t hashBytes( uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for( size_t i=0; i<length; i++) {
+        hash = (hash ^ bytes[ i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+uint64_t boardHash( const Board &board)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hash = hashBytes( hash, board.walls, sizeof( board.walls));
+    hash = hashBytes( hash, board.targets, sizeof( board.targets));
+    return hash;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Game records
+//      A game record file keeps finished games in as few bytes as can be, so that
+//      archives of millions of games can be checked quickly.  The file is a
+//      GameRecordFileHeader, then the records one after another:
+//
+//          board hash     8 bytes, boardHash() of the board the game was played on
+//          move count     2 bytes, the number of moves the game claims to take
+//          goal robot     1 byte, 1..NUMBER_OF_ROBOTS
+//          goal letter    1 byte, 'A'..'Z'
+//          robots         NUMBER_OF_ROBOTS bytes, the starting squares of robots 1, 2, ...
+//          moves          a (robot-1)*4 + direction code of GAME_RECORD_MOVE_BITS for
+//                         each move, filling each byte from its low bits up
+//
+//      With up to four robots a move is 4 bits, so a 20 move game takes 26 bytes.
+//      Numbers are in the byte order of the machine, as in the other files.  A game
+//      is valid if every move moves its robot, and the goal robot stops on the goal
+//      with the last move and not before, which is where playGame() ends the game.
+//
+const uint32_t GAME_RECORD_MAGIC = 0x52475252;      // "RRGR" in a little-endian file
+const uint32_t GAME_RECORD_VERSION = 1;
+const int GAME_RECORD_MOVE_BITS = (NUMBER_OF_ROBOTS <= 4) ? 4 : 8;
+const int GAME_RECORD_START_BYTES = 12 + NUMBER_OF_ROBOTS;     // bytes before the moves
+const int GAME_RECORD_MAX_MOVES = 0xFFFF;
+
+struct GameRecordFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t boardEdge;        // BOARD_EDGE of the program that wrote it
+    uint32_t numberOfRobots;   // NUMBER_OF_ROBOTS of the program that wrote it
+};
+
+// Bytes taken by the moves of a record
+inline size_t gameRecordMoveBytes( int moveCount)
+{
+    return ((size_t)moveCount * GAME_RECORD_MOVE_BITS + 7) / 8;
+}
+
+// Number of moves a record claims
+inline int gameRecordMoveCount( const unsigned char *record)
+{
+    uint16_t moveCount;
+    memcpy( &moveCount, record + 8, sizeof( moveCount));
+    return moveCount;
+}
+
+
+//-------------------------------------------------------------------------------------
+// encodeGameRecord()
+//      Append the record of a game to record.  The moves are those applied so far;
+//      undone moves are left out, and so are moves that left their robot where it
+//      was, since they change nothing.  The move count is gameMovesMade(), the count
+//      playGame() gives the player.  Returns false, adding nothing, if the game has
+//      more than GAME_RECORD_MAX_MOVES moves.
+//
+bool encodeGameRecord( const Game &game,                   // game to record
+                       uint64_t gameBoardHash,             // boardHash() of the game's board
+                       vector< unsigned char> &record)     // the record is added to the end
+{
+    // the starting squares come from taking back the moves
+    int robots[ NUMBER_OF_ROBOTS + 1];
+    memcpy( robots, game.robots, sizeof( robots));
+    for( size_t i=game.history.current; i>0; i--) {
+        robots[ game.history.records[ i-1].robot] = game.history.records[ i-1].from;
+    }
+    int moveCount = gameMovesMade( game);
+    if( moveCount > GAME_RECORD_MAX_MOVES) {
+        return false;
+    }
+
+    size_t start = record.size();
+    record.resize( start + GAME_RECORD_START_BYTES + gameRecordMoveBytes( moveCount), 0);
+    unsigned char *bytes = &record[ start];
+    uint16_t storedCount = (uint16_t)moveCount;
+    memcpy( bytes, &gameBoardHash, sizeof( gameBoardHash));
+    memcpy( bytes + 8, &storedCount, sizeof( storedCount));
+    bytes[ 10] = (unsigned char)game.goalRobot;
+    bytes[ 11] = (unsigned char)game.destinationLetter;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        bytes[ 11 + i] = (unsigned char)robots[ i];
+    }
+    unsigned char *moves = bytes + GAME_RECORD_START_BYTES;
+    for( size_t i=0, bit=0; i<game.history.current; i++) {
+        const MoveRecord &move = game.history.records[ i];
+        if( move.from == move.to) {
+            continue;
+        }
+        // the direction follows from the squares: along the row is left or right
+        int direction;
+        if( (move.from / BOARD_EDGE) == (move.to / BOARD_EDGE)) {
+            direction = (move.to < move.from) ? LEFT : RIGHT;
+        }
+        else {
+            direction = (move.to < move.from) ? ABOVE : BELOW;
+        }
+        int code = (move.robot - 1) * NUMBER_OF_DIRECTIONS + direction;
+        moves[ bit / 8] |= (unsigned char)(code << (bit % 8));
+        bit += GAME_RECORD_MOVE_BITS;
+    }
+    return true;
+}//end encodeGameRecord()
+
+
+//-------------------------------------------------------------------------------------
+// appendGameRecord()
+//      Add the record of a game to the end of a game record file, starting the file
+//      if there is none.  Returns false if the file can't be written, or holds games
+//      of a different board size or number of robots.
+//
+bool appendGameRecord( const char *fileName, const Game &game)
+{
+    vector< unsigned char> record;
+    if( !encodeGameRecord( game, boardHash( *game.board), record)) {
+        return false;
+    }
+    GameRecordFileHeader expected = { GAME_RECORD_MAGIC, GAME_RECORD_VERSION, BOARD_EDGE, NUMBER_OF_ROBOTS };
+    struct stat fileStatus;
+    bool fresh = (stat( fileName, &fileStatus) != 0) || (fileStatus.st_size == 0);
+    if( !fresh) {
+        GameRecordFileHeader found;
+        ifstream inStream( fileName, ios::binary);
+        inStream.read( (char *)&found, sizeof( found));
+        if( inStream.fail() || (memcmp( &found, &expected, sizeof( expected)) != 0)) {
+            return false;
+        }
+    }
+    ofstream outStream( fileName, ios::binary | ios::app);
+    if( fresh) {
+        outStream.write( (const char *)&expected, sizeof( expected));
+    }
+    outStream.write( (const char *)&record[ 0], record.size());
+    return !outStream.fail();
+}//end appendGameRecord()
+
+
+//-------------------------------------------------------------------------------------
+// checkGameRecord()
+//      Replay one record on the board it was played on.  Returns NULL if the game is
+//      valid, or else what is wrong with it.  The robots are kept in a state key and
+//      moved with slideRobot(), so nothing is allocated or drawn.
+//
+const char *checkGameRecord( const Board &board, const unsigned char *record)
+{
+    int moveCount = gameRecordMoveCount( record);
+    int goalRobot = record[ 10];
+    int letter = record[ 11] - 'A';
+    if( (goalRobot < 1) || (goalRobot > NUMBER_OF_ROBOTS) || (letter < 0) || (letter >= NUMBER_OF_LETTERS) ||
+        (board.targets[ letter] < 0)) {
+        return "the goal is not on the board";
+    }
+    int goalPosition = board.targets[ letter];
+
+    // the robots must start on different squares of the board
+    const unsigned char *robots = record + 12;
+    StateKey key = 0;
+    for( int i=NUMBER_OF_ROBOTS-1; i>=0; i--) {
+        for( int j=0; j<i; j++) {
+            if( robots[ j] == robots[ i]) {
+                return "two robots start on one square";
+            }
+        }
+        if( robots[ i] >= BOARD_SIZE) {
+            return "a robot starts off the board";
+        }
+        key = (key << 8) | robots[ i];
+    }
+
+    const unsigned char *moves = record + GAME_RECORD_START_BYTES;
+    for( int i=0; i<moveCount; i++) {
+        int bit = i * GAME_RECORD_MOVE_BITS;
+        int code = (moves[ bit / 8] >> (bit % 8)) & ((1 << GAME_RECORD_MOVE_BITS) - 1);
+        int robot = code / NUMBER_OF_DIRECTIONS + 1;
+        if( robot > NUMBER_OF_ROBOTS) {
+            return "a move of a robot that isn't in the game";
+        }
+        int from = robotPosition( key, robot);
+        int to = slideRobot( board, key, robot, code % NUMBER_OF_DIRECTIONS);
+        if( to == from) {
+            return "a move doesn't move its robot";
+        }
+        key += ((StateKey)to - (StateKey)from) << (8 * (robot-1));
+        if( (robot == goalRobot) && (to == goalPosition)) {
+            return (i == moveCount - 1) ? NULL : "the goal is reached in fewer moves than claimed";
+        }
+    }
+    return "the goal is not reached in the moves claimed";
+}//end checkGameRecord()
+
+
+//-------------------------------------------------------------------------------------
+// Solver
+//      The solver finds a shortest sequence of moves that gets the goal robot to the
+//      goal square, by breadth-first search over packed robot states.  The walls never
+//      change during a search, so only the state key is stored for each state, and the
+//      moves from a state come from generateSuccessors().  States are stored by their
+//      canonicalKey(), so helper robots swapping places is not a new state.
+//
+
+// Default limit on solution length, so an unreachable goal does not exhaust memory
+const int DEFAULT_MAX_SOLUTION_MOVES = 30;
+// Default depth for rating every goal at once.  That search can only stop early if
+// every robot reaches every letter, so it needs a lower limit.
+const int DEFAULT_RATE_MOVES = 12;
+// States expanded at a time by the breadth-first search, and how many successors
+// ahead of the one being looked up its visited set slot is fetched
+const int SOLVER_BATCH = 32;
+const int SOLVER_PREFETCH_DISTANCE = 8;
+// Number of entries in the IDA* bound table (8 bytes each with 32-bit keys, 32 MB).
+// Must be a power of 2.
+const int BOUND_TABLE_SIZE = 1 << 22;
+// goalDistance value for squares the goal robot can never reach the goal from
+const unsigned char UNREACHABLE = 255;
+
+// One move of a solution
+struct SolverMove {
+    int robot;          // robot number, 1..NUMBER_OF_ROBOTS
+    char direction;     // L, U, R or D
+};
+
+// Convert a move code from generateSuccessors() into a SolverMove
+inline SolverMove solverMoveFromCode( int moveCode)
+{
+    SolverMove move;
+    move.robot = moveCode / NUMBER_OF_DIRECTIONS + 1;
+    move.direction = DIRECTION_LETTERS[ moveCode % NUMBER_OF_DIRECTIONS];
+    return move;
+}
+
+
+//-------------------------------------------------------------------------------------
+// canonicalKey()
+//      Only the goal robot has to reach anything.  The other robots are just blockers,
+//      and it doesn't matter which of them stands where, so states that differ only by
+//      swapping helper robots have the same solutions.  The canonical key keeps the
+//      goal robot in its own byte and sorts the helper positions into the other bytes
+//      in increasing order, so all of those states have one key.  The searches store
+//      and compare canonical keys, which cuts the states visited by up to 3! = 6 times
+//      with four robots.  The goal robot's position is the same in both keys.
+//
+inline StateKey canonicalKey( StateKey key, int goalRobot)
+{
+    // close up the gap left by taking out the goal robot, so the helpers are in the
+    // low bytes.  Every index from here on is a constant, so there are no branches.
+    StateKey goalMask = (StateKey)0xFF << (8 * (goalRobot-1));
+    StateKey belowGoal = ((StateKey)1 << (8 * (goalRobot-1))) - 1;    // bytes of the robots before it
+    StateKey helperKey = (key & belowGoal) | ((key >> 8) & ~belowGoal);
+
+    // odd-even transposition sort: a fixed sequence of compare and swaps, which the
+    // compiler turns into min and max
+    int helpers[ NUMBER_OF_ROBOTS - 1];
+    for( int i=0; i<NUMBER_OF_ROBOTS - 1; i++) {
+        helpers[ i] = (int)(helperKey >> (8 * i)) & 0xFF;
+    }
+    for( int round=0; round<NUMBER_OF_ROBOTS - 1; round++) {
+        for( int i=round & 1; i+1<NUMBER_OF_ROBOTS - 1; i+=2) {
+            int low = min( helpers[ i], helpers[ i+1]);
+            helpers[ i+1] = max( helpers[ i], helpers[ i+1]);
+            helpers[ i] = low;
+        }
+    }
+    StateKey sorted = 0;
+    for( int i=0; i<NUMBER_OF_ROBOTS - 1; i++) {
+        sorted |= (StateKey)helpers[ i] << (8 * i);
+    }
+
+    // open the gap again and put the goal robot back
+    return (sorted & belowGoal) | ((sorted & ~belowGoal) << 8) | (key & goalMask);
+}//end canonicalKey()
+
+
+//-------------------------------------------------------------------------------------
+// canonicalMovesToSolution()
+//      A search over canonical keys finds moves that name robots by their byte in the
+//      canonical key, which need not be the robot's own number.  Replay them from the
+//      real start: each move is made by the robot standing on the square that byte
+//      gives in the canonical state it was made from.  moves holds that state and the
+//      move code for each move, in order.
+//
+void canonicalMovesToSolution( const Board &board,                              // board the moves are on
+                               const int startRobots[ NUMBER_OF_ROBOTS + 1],     // robot positions, theRobots layout
+                               const vector< pair< StateKey, int>> &moves,      // canonical state and move code
+                               vector<SolverMove> &solution)                    // returns the moves
+{
+    int robots[ NUMBER_OF_ROBOTS + 1];
+    memcpy( robots, startRobots, sizeof( robots));
+    solution.clear();
+    for( size_t i=0; i<moves.size(); i++) {
+        int slot = moves[ i].second / NUMBER_OF_DIRECTIONS + 1;
+        int direction = moves[ i].second % NUMBER_OF_DIRECTIONS;
+        int from = robotPosition( moves[ i].first, slot);
+        int robot = 1;
+        while( robots[ robot] != from) {
+            robot++;
+        }
+        // the canonical state has the same robots on the same squares, so the slide ends the same way
+        robots[ robot] = slideRobot( board, moves[ i].first, slot, direction);
+        SolverMove move;
+        move.robot = robot;
+        move.direction = DIRECTION_LETTERS[ direction];
+        solution.push_back( move);
+    }
+}//end canonicalMovesToSolution()
+
+// One entry of the IDA* bound table, see boundTableCovers()
+struct BoundEntry {
+    StateKey key;
+    uint32_t movesAndGeneration;       // moves left (bits 0-7) and solve generation (bits 8-31)
+};
+
+// Solver statistics
+//      Set collectStats in a SolverContext and solvePuzzle() and solvePuzzleIDA() fill
+//      in its stats.  The searches are templates on whether they collect statistics, so
+//      a solve that doesn't collect them runs the same code as before.  The parallel,
+//      compact and external solvers' contexts have collectStats and stats too; they
+//      count a whole level at a time, so they check it once a level.  Building with
+//      -DSOLVER_STATS=0 removes the statistics code altogether.
+//
+#ifndef SOLVER_STATS
+#define SOLVER_STATS 1
+#endif
+constexpr bool SOLVER_STATS_ENABLED = (SOLVER_STATS != 0);
+
+// Counts for one depth of a search.  For IDA* they add up every iteration.
+struct DepthStats {
+    long expanded;             // states expanded at this depth (the breadth-first frontier)
+    long generated;            // successors generated from them
+    long duplicates;           // successors already reached, or covered by the bound table
+    long pruned;               // IDA* successors cut off by the bound or the move order rule
+    double startMicroseconds;  // breadth-first: when this depth started, from the start of the solve
+    double microseconds;       // breadth-first: time spent expanding this depth
+};
+
+// One IDA* iteration
+struct IterationStats {
+    int bound;                 // longest solution allowed
+    long expanded;             // states expanded
+    double startMicroseconds;  // when the iteration started, from the start of the solve
+    double microseconds;       // time the iteration took
+};
+
+struct SolverStats {
+    string search;             // "bfs", "ida", "parallel", "compact" or "external"
+    long expanded;             // totals over all depths
+    long generated;
+    long duplicates;
+    long pruned;
+    long hashLookups;          // breadth-first visited set: keys looked up
+    long hashProbes;           // slots examined for them, so probes / lookups is the average probe length
+    long longestProbe;         // most slots examined for one key
+    double hashLoad;           // visited set or bound table entries in use / slots, at the end
+                               //      (compact search: pages in use / pages)
+    size_t peakBytes;          // largest memory held by the search's arrays
+    uint64_t diskBytes;        // external search: most bytes its files took at once
+    double microseconds;       // time for the whole solve
+    vector< DepthStats> depths;
+    vector< IterationStats> iterations;
+};
+
+// Exact moves to the goal from a state, as found by a hint search, see HintEngine
+struct KnownState {
+    unsigned char moves;       // fewest moves to the goal
+    unsigned char moveCode;    // first move of such a solution: (robot-1)*4 + direction
+};
+typedef unordered_map< StateKey, KnownState> KnownStates;
+
+// Solver scratch memory.  Keep one of these around and pass it to every solve, so the
+// arrays keep their capacity and are not reallocated for each puzzle.
+struct SolverContext {
+    vector<StateKey> stateKeys;        // every state reached, in breadth-first order
+    vector<uint32_t> parentIndex;      // index in stateKeys of the state each one was reached from
+    vector<unsigned char> moveCodes;   // move that reached each state: (robot-1)*4 + direction
+    vector<StateKey> visited;          // hash set of keys already reached.  0 marks an empty slot,
+                                       //      which is safe since robots never share square 0.
+    uint32_t visitedMask;              // visited.size() - 1.  The size is always a power of 2.
+    uint32_t visitedCount;             // number of keys in the visited set
+    long statesExpanded;               // number of states expanded by the last solve
+
+    // Memory for solvePuzzleIDA(), which stays the same size however deep the search goes
+    unsigned char goalDistance[ BOARD_SIZE];  // lower bound on goal robot moves from each square
+    vector<BoundEntry> boundTable;     // states already searched without finding the goal, see
+                                       //      boundTableCovers().  Always BOUND_TABLE_SIZE entries.
+    uint32_t boundGeneration;          // marks the boundTable entries written by the current solve
+    const KnownStates *knownStates;    // hint searches: exact moves to the goal from some states
+    const atomic< bool> *interrupt;    // hint searches: set to stop the search, see HintEngine
+
+    bool collectStats;                 // fill in stats on each solve, see SolverStats
+    SolverStats stats;                 // statistics for the last solve, if collectStats is set
+
+    SolverContext() : visitedMask( 0), visitedCount( 0), statesExpanded( 0), boundGeneration( 0),
+                      knownStates( NULL), interrupt( NULL), collectStats( false) { }
+};
+
+
+//-------------------------------------------------------------------------------------
+// visitedInsert()
+//      Add a key to the solver's visited set.  Returns false if it was already there.
+//      The table is doubled whenever it gets half full, to keep probe sequences short.
+//      With STATS set the probes are counted in the context's stats.
+//
+template< bool STATS = false>
+bool visitedInsert( SolverContext &context, StateKey key)
+{
+    if( (context.visitedCount + 1) * 2 > context.visited.size()) {
+        // grow the table and re-insert all the keys it held
+        vector<StateKey> oldTable;
+        oldTable.swap( context.visited);
+        uint32_t newSize = oldTable.empty() ? (1 << 16) : (uint32_t)oldTable.size() * 2;
+        context.visited.assign( newSize, 0);
+        context.visitedMask = newSize - 1;
+        for( size_t i=0; i<oldTable.size(); i++) {
+            if( oldTable[ i] != 0) {
+                uint32_t slot = hashSlot( oldTable[ i], context.visitedMask);
+                while( context.visited[ slot] != 0) {
+                    slot = (slot + 1) & context.visitedMask;
+                }
+                context.visited[ slot] = oldTable[ i];
+            }
+        }
+    }
+
+    // linear probing from the hashed slot
+    uint32_t slot = hashSlot( key, context.visitedMask);
+    uint32_t firstSlot = slot;
+    while( (context.visited[ slot] != 0) && (context.visited[ slot] != key)) {
+        slot = (slot + 1) & context.visitedMask;
+    }
+    if( STATS) {
+        long probes = (long)((slot - firstSlot) & context.visitedMask) + 1;
+        context.stats.hashLookups++;
+        context.stats.hashProbes += probes;
+        context.stats.longestProbe = max( context.stats.longestProbe, probes);
+    }
+    if( context.visited[ slot] == key) {
+        return false;      // already visited
+    }
+    context.visited[ slot] = key;
+    context.visitedCount++;
+    return true;
+}//end visitedInsert()
+
+
+//-------------------------------------------------------------------------------------
+// resetSolverStats(), addUpDepthStats() and microsecondsSince()
+//
+void resetSolverStats( SolverStats &stats, const char *search)
+{
+    stats.search = search;
+    stats.expanded = stats.generated = stats.duplicates = stats.pruned = 0;
+    stats.hashLookups = stats.hashProbes = stats.longestProbe = 0;
+    stats.hashLoad = 0;
+    stats.peakBytes = 0;
+    stats.diskBytes = 0;
+    stats.microseconds = 0;
+    stats.depths.clear();
+    stats.iterations.clear();
+}
+
+// Add the depths up into the totals, once the search is done
+void addUpDepthStats( SolverStats &stats)
+{
+    for( size_t depth=0; depth<stats.depths.size(); depth++) {
+        stats.expanded += stats.depths[ depth].expanded;
+        stats.generated += stats.depths[ depth].generated;
+        stats.duplicates += stats.depths[ depth].duplicates;
+        stats.pruned += stats.depths[ depth].pruned;
+    }
+}
+
+inline double microsecondsSince( chrono::steady_clock::time_point start)
+{
+    return chrono::duration< double, micro>( chrono::steady_clock::now() - start).count();
+}
+
+// Make sure stats has an entry for depth
+inline DepthStats &depthStats( SolverStats &stats, int depth)
+{
+    if( depth >= (int)stats.depths.size()) {
+        DepthStats empty = { 0, 0, 0, 0, 0, 0 };
+        stats.depths.resize( depth + 1, empty);
+    }
+    return stats.depths[ depth];
+}
+
+
+//-------------------------------------------------------------------------------------
+// solvePuzzle()
+//      Breadth-first search from the given robot positions until the goal robot stops
+//      on goalPosition.  Fills in solution with a shortest sequence of moves and returns
+//      true, or returns false if there is no solution of at most maxMoves moves.
+//      Moves are tried robot 1, 2, ..., and for each robot in the order L, U, R, D, so the
+//      same puzzle always gives the same solution.  breadthFirstSearch() is the search
+//      itself, with or without statistics.
+//
+template< bool STATS>
+bool breadthFirstSearch( SolverContext &context,                        // reusable scratch memory
+                         const Board &board,                             // compiled board to solve on
+                         const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                         int goalRobot,                                  // robot that needs to reach destination
+                         int goalPosition,                               // square it has to stop on
+                         int maxMoves,                                   // longest solution to look for
+                         vector<SolverMove> &solution)                   // returns the moves found
+{
+    // reset the scratch memory, keeping the capacity of the arrays
+    context.stateKeys.clear();
+    context.parentIndex.clear();
+    context.moveCodes.clear();
+    fill( context.visited.begin(), context.visited.end(), 0);
+    context.visitedCount = 0;
+    context.statesExpanded = 0;
+    solution.clear();
+    chrono::steady_clock::time_point solveStart;
+    if( STATS) {
+        resetSolverStats( context.stats, "bfs");
+        solveStart = chrono::steady_clock::now();
+    }
+
+    StateKey startKey = canonicalKey( packRobots( startRobots), goalRobot);
+    if( startRobots[ goalRobot] == goalPosition) {
+        return true;       // nothing to do
+    }
+    context.stateKeys.push_back( startKey);
+    context.parentIndex.push_back( 0);
+    context.moveCodes.push_back( 0);
+    visitedInsert< STATS>( context, startKey);
+
+    size_t levelStart = 0;       // first state of the depth being expanded
+    size_t foundIndex = 0;       // state where the goal was reached, 0 if not yet found
+    for( int depth=0; (depth < maxMoves) && (foundIndex == 0); depth++) {
+        size_t levelEnd = context.stateKeys.size();
+        if( levelStart == levelEnd) {
+            break;     // every reachable state has been seen
+        }
+        chrono::steady_clock::time_point levelStartTime;
+        if( STATS) {
+            levelStartTime = chrono::steady_clock::now();
+            depthStats( context.stats, depth).startMicroseconds = microsecondsSince( solveStart);
+        }
+        for( size_t batchStart=levelStart; (batchStart < levelEnd) && (foundIndex == 0); batchStart += SOLVER_BATCH) {
+            // expand a batch of states, then look the successors up in the visited set
+            // with the slots of the next few already on their way into the cache
+            size_t batchSize = min( (size_t)SOLVER_BATCH, levelEnd - batchStart);
+            StateKey successors[ SOLVER_BATCH * MAX_SUCCESSORS];
+            unsigned char successorMoves[ SOLVER_BATCH * MAX_SUCCESSORS];
+            uint32_t parents[ SOLVER_BATCH * MAX_SUCCESSORS];
+            size_t count = generateSuccessorBatch( board, &context.stateKeys[ batchStart], batchSize,
+                                                   successors, successorMoves, parents);
+            for( size_t i=0; i<count; i++) {
+                successors[ i] = canonicalKey( successors[ i], goalRobot);
+            }
+            size_t expanded = batchSize;
+            size_t generated = count;
+            for( size_t i=0; i<count; i++) {
+                if( i + SOLVER_PREFETCH_DISTANCE < count) {
+                    prefetch( &context.visited[ hashSlot( successors[ i + SOLVER_PREFETCH_DISTANCE], context.visitedMask)]);
+                }
+                if( !visitedInsert< STATS>( context, successors[ i])) {
+                    if( STATS) {
+                        context.stats.depths[ depth].duplicates++;
+                    }
+                    continue;      // already reached in as few moves
+                }
+                context.stateKeys.push_back( successors[ i]);
+                context.parentIndex.push_back( (uint32_t)(batchStart + parents[ i]));
+                context.moveCodes.push_back( successorMoves[ i]);
+                // only a move of the goal robot can put it on the goal
+                if( robotPosition( successors[ i], goalRobot) == goalPosition) {
+                    foundIndex = context.stateKeys.size() - 1;
+                    // the states after this one's parent didn't need expanding
+                    expanded = parents[ i] + 1;
+                    for( generated=i+1; (generated < count) && (parents[ generated] == parents[ i]); generated++) {
+                    }
+                    break;
+                }
+            }
+            context.statesExpanded += expanded;
+            if( STATS) {
+                context.stats.depths[ depth].expanded += expanded;
+                context.stats.depths[ depth].generated += generated;
+            }
+        }
+        if( STATS) {
+            context.stats.depths[ depth].microseconds = microsecondsSince( levelStartTime);
+        }
+        levelStart = levelEnd;
+    }
+
+    if( STATS) {
+        SolverStats &stats = context.stats;
+        addUpDepthStats( stats);
+        stats.hashLoad = context.visited.empty() ? 0 : (double)context.visitedCount / context.visited.size();
+        stats.peakBytes = context.stateKeys.capacity() * sizeof( StateKey) +
+                          context.parentIndex.capacity() * sizeof( uint32_t) +
+                          context.moveCodes.capacity() + context.visited.size() * sizeof( StateKey);
+        stats.microseconds = microsecondsSince( solveStart);
+    }
+    if( foundIndex == 0) {
+        return false;
+    }
+
+    // walk the parent links back to the start, then reverse to get the moves in order
+    vector< pair< StateKey, int>> moves;
+    for( size_t index=foundIndex; index != 0; index=context.parentIndex[ index]) {
+        moves.push_back( make_pair( context.stateKeys[ context.parentIndex[ index]], (int)context.moveCodes[ index]));
+    }
+    reverse( moves.begin(), moves.end());
+    canonicalMovesToSolution( board, startRobots, moves, solution);
+    return true;
+}//end breadthFirstSearch()
+
+bool solvePuzzle( SolverContext &context,                        // reusable scratch memory
+                  const Board &board,                             // compiled board to solve on
+                  const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                  int goalRobot,                                  // robot that needs to reach destination
+                  int goalPosition,                               // square it has to stop on
+                  int maxMoves,                                   // longest solution to look for
+                  vector<SolverMove> &solution)                   // returns the moves found
+{
+    if( SOLVER_STATS_ENABLED && context.collectStats) {
+        return breadthFirstSearch< true>( context, board, startRobots, goalRobot, goalPosition, maxMoves, solution);
+    }
+    return breadthFirstSearch< false>( context, board, startRobots, goalRobot, goalPosition, maxMoves, solution);
+}//end solvePuzzle()
+
+
+//-------------------------------------------------------------------------------------
+// computeGoalDistances()
+//      Fill in distance[] with the fewest moves the goal robot needs to get from each
+//      square to goalPosition, with the other robots off the board.  Since the other
+//      robots could be anywhere, a move may end on any square of the slide, not only
+//      at the wall.  That makes the distance a lower bound on the real number of moves,
+//      as IDA* requires.  Works backwards from the goal, breadth first.
+//
+void computeGoalDistances( const Board &board,                     // board walls
+                           int goalPosition,                       // square the goal robot must reach
+                           unsigned char distance[ BOARD_SIZE])    // returns moves from each square
+{
+    for( int i=0; i<BOARD_SIZE; i++) {
+        distance[ i] = UNREACHABLE;
+    }
+    int queue[ BOARD_SIZE];     // each square is queued at most once
+    int head = 0, tail = 0;
+    distance[ goalPosition] = 0;
+    queue[ tail++] = goalPosition;
+
+    while( head < tail) {
+        int square = queue[ head++];
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            // Squares that can slide onto this one moving in direction lie behind it,
+            // back as far as the first wall on the opposite side.
+            int back = OPPOSITE_DIRECTION[ direction];
+            int position = square;
+            while( !bitboardTest( board.walls[ back], position)) {
+                position += DIRECTION_OFFSETS[ back];
+                if( distance[ position] == UNREACHABLE) {
+                    distance[ position] = distance[ square] + 1;
+                    queue[ tail++] = position;
+                }
+            }
+        }
+    }
+}//end computeGoalDistances()
+
+
+//-------------------------------------------------------------------------------------
+// boundTableCovers() and boundTableStore()
+//      The bound table remembers states that have already been searched with some
+//      number of moves left without reaching the goal.  Reaching one again with no
+//      more moves left can't succeed either, so it is skipped.  Each entry holds the
+//      key, the moves left and the solve's generation, so starting a new solve does
+//      not need to clear the table.  An entry is simply overwritten when another state
+//      hashes to the same slot.
+//
+inline bool boundTableCovers( const SolverContext &context, StateKey key, int movesLeft)
+{
+    const BoundEntry &entry = context.boundTable[ hashSlot( key, BOUND_TABLE_SIZE - 1)];
+    return (entry.key == key) && ((entry.movesAndGeneration >> 8) == context.boundGeneration) &&
+           ((int)(entry.movesAndGeneration & 0xFF) >= movesLeft);
+}
+
+inline void boundTableStore( SolverContext &context, StateKey key, int movesLeft)
+{
+    BoundEntry &entry = context.boundTable[ hashSlot( key, BOUND_TABLE_SIZE - 1)];
+    entry.key = key;
+    entry.movesAndGeneration = (uint32_t)movesLeft | (context.boundGeneration << 8);
+}
+
+// Moves left stored for a state by this generation, -1 if none
+inline int boundTableMoves( const SolverContext &context, StateKey key)
+{
+    const BoundEntry &entry = context.boundTable[ hashSlot( key, BOUND_TABLE_SIZE - 1)];
+    if( (entry.key != key) || ((entry.movesAndGeneration >> 8) != context.boundGeneration)) {
+        return -1;
+    }
+    return (int)(entry.movesAndGeneration & 0xFF);
+}
+
+// Start a new generation of bound table entries, clearing the table if it wraps
+void startBoundGeneration( SolverContext &context)
+{
+    if( context.boundTable.empty()) {
+        BoundEntry empty = { 0, 0 };
+        context.boundTable.assign( BOUND_TABLE_SIZE, empty);
+    }
+    context.boundGeneration = (context.boundGeneration + 1) & 0xFFFFFF;
+    if( context.boundGeneration == 0) {
+        BoundEntry empty = { 0, 0 };
+        fill( context.boundTable.begin(), context.boundTable.end(), empty);
+        context.boundGeneration = 1;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// idaSearch()
+//      Depth-first part of solvePuzzleIDA().  Tries every move from the state, in the
+//      same order as solvePuzzle(), skipping any child whose depth plus goal distance
+//      is over bound.  Returns true with the moves in path once the goal is reached.
+//      Otherwise nextBound is lowered to the smallest estimate that was over bound.
+//
+//      Two moves of different robots often don't affect each other, and then making
+//      them in either order gives the same state.  Only the order with the lower
+//      robot number first is searched.
+//
+//      With HINTS, a state in context.knownStates counts as reached if its known moves
+//      fit in the bound, and the path then ends at that state instead of the goal.
+//      The bound table is kept for later searches from other states then, so both
+//      orders of two moves are searched: skipping one is only safe while the same
+//      iteration searches the other, so an entry stored under that skip would not be
+//      proven on its own.  For the same reason a child skipped for its bound table
+//      entry counts towards nextBound.  Setting *context.interrupt makes the search
+//      return false at once, storing nothing more in the bound table.
+//
+template< bool STATS, bool HINTS = false>
+bool idaSearch( SolverContext &context,          // scratch memory, goal distances and bound table
+                const Board &board,              // board to solve on
+                StateKey key,                    // state to search from
+                StateKey parentKey,              // state before the last move
+                int lastRobot,                   // robot moved by the last move, 0 at the start
+                int lastDirection,               // direction of the last move
+                int goalRobot,                   // robot that needs to reach destination
+                int goalPosition,                // square it has to stop on
+                int depth,                       // moves made to reach key
+                int bound,                       // longest solution allowed in this iteration
+                int &nextBound,                  // returns the bound for the next iteration
+                vector<SolverMove> &path)        // moves from the start to key, and on success to the goal
+{
+    if( HINTS && context.interrupt->load( memory_order_relaxed)) {
+        return false;
+    }
+    context.statesExpanded++;
+
+    StateKey successors[ MAX_SUCCESSORS];
+    unsigned char successorMoves[ MAX_SUCCESSORS];
+    int count = generateSuccessors( board, key, successors, successorMoves);
+    if( STATS) {
+        depthStats( context.stats, depth).expanded++;
+        context.stats.depths[ depth].generated += count;
+    }
+    int goalRobotEstimate = context.goalDistance[ robotPosition( key, goalRobot)];
+    for( int i=0; i<count; i++) {
+        StateKey nextKey = successors[ i];
+        int robot = successorMoves[ i] / NUMBER_OF_DIRECTIONS + 1;
+        int direction = successorMoves[ i] % NUMBER_OF_DIRECTIONS;
+        int to = robotPosition( nextKey, robot);
+        if( !HINTS && (robot < lastRobot)) {
+            // Skip the move if it ends the same way before the last move, and the
+            // last move still ends the same way after it.  That order was searched.
+            StateKey swappedKey = (parentKey & ~((StateKey)0xFF << (8 * (robot-1)))) |
+                                  ((StateKey)to << (8 * (robot-1)));
+            if( (slideRobot( board, parentKey, robot, direction) == to) &&
+                (slideRobot( board, swappedKey, lastRobot, lastDirection) == robotPosition( key, lastRobot))) {
+                if( STATS) {
+                    context.stats.depths[ depth].pruned++;
+                }
+                continue;
+            }
+        }
+        path.push_back( solverMoveFromCode( successorMoves[ i]));
+        if( (robot == goalRobot) && (to == goalPosition)) {
+            return true;
+        }
+        if( HINTS) {
+            KnownStates::const_iterator known = context.knownStates->find( nextKey);
+            if( known != context.knownStates->end()) {
+                // the exact distance is the best estimate there is, no need to search
+                int estimate = depth + 1 + known->second.moves;
+                if( estimate <= bound) {
+                    return true;
+                }
+                if( estimate < nextBound) {
+                    nextBound = estimate;
+                }
+                path.pop_back();
+                continue;
+            }
+        }
+
+        // prune the child if even the goal distance alone takes it over the bound
+        int estimate = depth + 1 + ((robot == goalRobot) ? context.goalDistance[ to] : goalRobotEstimate);
+        if( estimate > bound) {
+            if( estimate < nextBound) {
+                nextBound = estimate;
+            }
+            if( STATS) {
+                context.stats.depths[ depth].pruned++;
+            }
+        }
+        else if( boundTableCovers( context, canonicalKey( nextKey, goalRobot), bound - depth - 1)) {
+            if( STATS) {
+                context.stats.depths[ depth].duplicates++;
+            }
+            if( HINTS) {
+                // The child needs more moves than the entry's, which the next bound has
+                // to allow for, since the entry may be from an earlier search.
+                int estimate = depth + 2 + boundTableMoves( context, canonicalKey( nextKey, goalRobot));
+                if( estimate < nextBound) {
+                    nextBound = estimate;
+                }
+            }
+        }
+        else if( idaSearch< STATS, HINTS>( context, board, nextKey, key, robot, direction, goalRobot, goalPosition,
+                                           depth + 1, bound, nextBound, path)) {
+            return true;
+        }
+        path.pop_back();
+    }
+
+    if( HINTS && context.interrupt->load( memory_order_relaxed)) {
+        return false;      // some moves weren't searched
+    }
+    boundTableStore( context, canonicalKey( key, goalRobot), bound - depth);
+    return false;
+}//end idaSearch()
+
+
+//-------------------------------------------------------------------------------------
+// solvePuzzleIDA()
+//      Iterative-deepening A* version of solvePuzzle(), with the same parameters and
+//      results.  Each iteration is a depth-first search limited by the goal distances
+//      from computeGoalDistances(), and the limit is raised until the goal is found.
+//      Memory use is the recursion (one level per move) plus the fixed-size bound
+//      table, so hard puzzles can't run out of memory the way breadth-first search can.
+//
+template< bool STATS>
+bool iterativeDeepeningSearch( SolverContext &context,                        // reusable scratch memory
+                                const Board &board,                             // compiled board to solve on
+                                const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                                int goalRobot,                                  // robot that needs to reach destination
+                                int goalPosition,                               // square it has to stop on
+                                int maxMoves,                                   // longest solution to look for
+                                vector<SolverMove> &solution)                   // returns the moves found
+{
+    context.statesExpanded = 0;
+    solution.clear();
+    chrono::steady_clock::time_point solveStart;
+    if( STATS) {
+        resetSolverStats( context.stats, "ida");
+        solveStart = chrono::steady_clock::now();
+    }
+    if( startRobots[ goalRobot] == goalPosition) {
+        return true;       // nothing to do
+    }
+    computeGoalDistances( board, goalPosition, context.goalDistance);
+    int bound = context.goalDistance[ startRobots[ goalRobot]];
+    if( bound == UNREACHABLE) {
+        return false;      // walls cut the goal robot off from the goal
+    }
+
+    startBoundGeneration( context);
+
+    StateKey startKey = packRobots( startRobots);
+    bool solved = false;
+    while( !solved && (bound <= maxMoves)) {
+        int nextBound = UNREACHABLE;
+        IterationStats iteration = { bound, context.statesExpanded, 0, 0 };
+        if( STATS) {
+            iteration.startMicroseconds = microsecondsSince( solveStart);
+        }
+        solved = idaSearch< STATS>( context, board, startKey, startKey, 0, 0, goalRobot, goalPosition,
+                                    0, bound, nextBound, solution);
+        if( STATS) {
+            iteration.expanded = context.statesExpanded - iteration.expanded;
+            iteration.microseconds = microsecondsSince( solveStart) - iteration.startMicroseconds;
+            context.stats.iterations.push_back( iteration);
+        }
+        bound = nextBound;
+    }
+
+    if( STATS) {
+        SolverStats &stats = context.stats;
+        addUpDepthStats( stats);
+        long entriesInUse = 0;
+        for( size_t i=0; i<context.boundTable.size(); i++) {
+            entriesInUse += ((context.boundTable[ i].movesAndGeneration >> 8) == context.boundGeneration);
+        }
+        stats.hashLoad = (double)entriesInUse / context.boundTable.size();
+        stats.peakBytes = context.boundTable.size() * sizeof( BoundEntry) + solution.capacity() * sizeof( SolverMove);
+        stats.microseconds = microsecondsSince( solveStart);
+    }
+    return solved;
+}//end iterativeDeepeningSearch()
+
+bool solvePuzzleIDA( SolverContext &context,                        // reusable scratch memory
+                     const Board &board,                             // compiled board to solve on
+                     const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                     int goalRobot,                                  // robot that needs to reach destination
+                     int goalPosition,                               // square it has to stop on
+                     int maxMoves,                                   // longest solution to look for
+                     vector<SolverMove> &solution)                   // returns the moves found
+{
+    if( SOLVER_STATS_ENABLED && context.collectStats) {
+        return iterativeDeepeningSearch< true>( context, board, startRobots, goalRobot, goalPosition, maxMoves, solution);
+    }
+    return iterativeDeepeningSearch< false>( context, board, startRobots, goalRobot, goalPosition, maxMoves, solution);
+}//end solvePuzzleIDA()
+
+
+//-------------------------------------------------------------------------------------
+// Hint engine
+//      Answers "how many moves are left, and what is a good next move" after every
+//      move of a game, without solving from scratch each time.  For as long as the
+//      board and goal stay the same it keeps
+//
+//        - the IDA* bound table.  Its entries say a state can't reach the goal in some
+//          number of moves, which stays true whatever state the next search starts
+//          from, so the next search skips everything already ruled out, and starts
+//          its bound at what is known for its own start.
+//        - known, the exact moves to the goal from every state on each solution
+//          found.  A known state needs no search, which covers following the hints,
+//          undo and redo.  The search treats a known state like the goal, so after
+//          a move off the path the search stops as soon as it gets back onto one.
+//
+//      A move that makes the puzzle longer still needs a new search, as long as a
+//      first solve.  So while the player thinks, a helper thread searches ahead from
+//      the position given to prepareHints(): the position itself, then every move
+//      from it, so whatever move is made next, its hint is known.  A hint that isn't
+//      known interrupts the helper and searches at once.
+//
+//      Locking: a search, or a change to the tables, holds searchLock.  known is also
+//      changed under knownLock, so findHint() can look a state up while the helper
+//      searches.  The engine has a SolverContext of its own, so it takes
+//      BOUND_TABLE_SIZE entries of memory, and its helper thread runs until the
+//      engine is destroyed.
+//
+struct HintEngine {
+    SolverContext context;          // IDA* scratch memory and the kept bound table
+    KnownStates known;              // exact moves to the goal, by state
+    const Board *board;             // board the tables are for
+    int goalRobot;                  // goal the tables are for
+    int goalPosition;
+
+    mutex searchLock;               // held while searching, or changing the tables
+    mutex knownLock;                // held while changing known, or reading it without searchLock
+    atomic< bool> interrupt;        // set while a hint waits for searchLock, stops the helper's search
+
+    // the helper thread's work
+    mutex aheadLock;                // guards the three below
+    condition_variable aheadReady;
+    int aheadRobots[ NUMBER_OF_ROBOTS + 1];   // position to search ahead from
+    bool aheadWaiting;              // aheadRobots is new
+    bool quitting;                  // the helper should exit
+    thread helper;
+
+    HintEngine();
+    ~HintEngine();
+};
+
+
+//-------------------------------------------------------------------------------------
+// setHintGoal()
+//      Point the engine at the game's board and goal.  If they are new, nothing kept
+//      so far applies, and the tables are started again.  Call with searchLock held.
+//
+void setHintGoal( HintEngine &engine, const Game &game)
+{
+    if( (engine.board == game.board.get()) && (engine.goalRobot == game.goalRobot) &&
+        (engine.goalPosition == game.goalPosition)) {
+        return;
+    }
+    lock_guard< mutex> hold( engine.knownLock);
+    engine.board = game.board.get();
+    engine.goalRobot = game.goalRobot;
+    engine.goalPosition = game.goalPosition;
+    engine.known.clear();
+    computeGoalDistances( *engine.board, engine.goalPosition, engine.context.goalDistance);
+    startBoundGeneration( engine.context);
+}
+
+
+//-------------------------------------------------------------------------------------
+// searchHint()
+//      Find the fewest moves to the goal from robots, and the first move of a
+//      solution that short, using and adding to the engine's tables.  Returns false
+//      if there is no solution of DEFAULT_MAX_SOLUTION_MOVES or less, or if the search
+//      was interrupted.  Call with searchLock held.
+//
+bool searchHint( HintEngine &engine,
+                 const int robots[ NUMBER_OF_ROBOTS + 1],     // position, theRobots layout
+                 int &movesLeft,                              // returns the fewest moves to the goal
+                 SolverMove &move)                            // returns the first of those moves
+{
+    const Board &board = *engine.board;
+    SolverContext &context = engine.context;
+    context.statesExpanded = 0;
+    movesLeft = 0;
+    if( robots[ engine.goalRobot] == engine.goalPosition) {
+        return true;
+    }
+    // known is only changed by searches, so reading it needs no knownLock here
+    StateKey startKey = packRobots( robots);
+    KnownStates::const_iterator known = engine.known.find( startKey);
+    if( known != engine.known.end()) {
+        movesLeft = known->second.moves;
+        move = solverMoveFromCode( known->second.moveCode);
+        return true;
+    }
+
+    // start from the best lower bound there is: the goal distance, or what the bound
+    // table says earlier searches ruled out
+    int bound = context.goalDistance[ robots[ engine.goalRobot]];
+    if( bound == UNREACHABLE) {
+        return false;      // walls cut the goal robot off from the goal
+    }
+    bound = max( bound, boundTableMoves( context, canonicalKey( startKey, engine.goalRobot)) + 1);
+
+    vector<SolverMove> path;
+    bool solved = false;
+    while( !solved && (bound <= DEFAULT_MAX_SOLUTION_MOVES) && !engine.interrupt) {
+        int nextBound = UNREACHABLE;
+        solved = idaSearch< false, true>( context, board, startKey, startKey, 0, 0, engine.goalRobot,
+                                          engine.goalPosition, 0, bound, nextBound, path);
+        bound = nextBound;
+    }
+    if( !solved) {
+        return false;
+    }
+
+    // The path ends at the goal, or at a known state.  Every state on it is now known.
+    int pathRobots[ NUMBER_OF_ROBOTS + 1];
+    memcpy( pathRobots, robots, sizeof( pathRobots));
+    vector< StateKey> pathKeys;
+    vector< unsigned char> pathCodes;
+    for( size_t i=0; i<path.size(); i++) {
+        int direction = (int)(find( DIRECTION_LETTERS, DIRECTION_LETTERS + NUMBER_OF_DIRECTIONS, path[ i].direction) -
+                              DIRECTION_LETTERS);
+        StateKey key = packRobots( pathRobots);
+        pathKeys.push_back( key);
+        pathCodes.push_back( (unsigned char)((path[ i].robot - 1) * NUMBER_OF_DIRECTIONS + direction));
+        pathRobots[ path[ i].robot] = slideRobot( board, key, path[ i].robot, direction);
+    }
+    known = engine.known.find( packRobots( pathRobots));
+    movesLeft = (int)path.size() + ((known != engine.known.end()) ? known->second.moves : 0);
+    lock_guard< mutex> hold( engine.knownLock);
+    for( size_t i=0; i<path.size(); i++) {
+        KnownState state = { (unsigned char)(movesLeft - i), pathCodes[ i] };
+        engine.known[ pathKeys[ i]] = state;
+    }
+    move = path[ 0];
+    return true;
+}//end searchHint()
+
+
+//-------------------------------------------------------------------------------------
+// findHint()
+//      Find the fewest moves left in game, and the first move of a solution that
+//      short.  Returns false if there is no solution of DEFAULT_MAX_SOLUTION_MOVES or
+//      less.  movesLeft is 0, and move not set, if the goal is already reached.
+//
+bool findHint( HintEngine &engine,         // tables kept from earlier hints
+               const Game &game,           // game to give a hint for
+               int &movesLeft,             // returns the fewest moves to the goal
+               SolverMove &move)           // returns the first of those moves
+{
+    movesLeft = 0;
+    if( goalReached( game)) {
+        return true;
+    }
+    {
+        // answer at once if the position is known, even while the helper searches
+        lock_guard< mutex> hold( engine.knownLock);
+        if( (engine.board == game.board.get()) && (engine.goalRobot == game.goalRobot) &&
+            (engine.goalPosition == game.goalPosition)) {
+            KnownStates::const_iterator known = engine.known.find( packRobots( game.robots));
+            if( known != engine.known.end()) {
+                movesLeft = known->second.moves;
+                move = solverMoveFromCode( known->second.moveCode);
+                return true;
+            }
+        }
+    }
+    engine.interrupt = true;         // stop the helper's search, and keep it from starting another
+    lock_guard< mutex> hold( engine.searchLock);
+    engine.interrupt = false;
+    setHintGoal( engine, game);
+    return searchHint( engine, game.robots, movesLeft, move);
+}//end findHint()
+
+
+//-------------------------------------------------------------------------------------
+// prepareHints()
+//      Have the helper thread search ahead from the game's position, replacing any
+//      position it was given before.  Call after each move, undo or redo.
+//
+void prepareHints( HintEngine &engine, const Game &game)
+{
+    bool sameGoal;
+    {
+        lock_guard< mutex> hold( engine.knownLock);
+        sameGoal = (engine.board == game.board.get()) && (engine.goalRobot == game.goalRobot) &&
+                   (engine.goalPosition == game.goalPosition);
+    }
+    if( !sameGoal) {
+        engine.interrupt = true;
+        lock_guard< mutex> hold( engine.searchLock);
+        engine.interrupt = false;
+        setHintGoal( engine, game);
+    }
+    lock_guard< mutex> hold( engine.aheadLock);
+    memcpy( engine.aheadRobots, game.robots, sizeof( engine.aheadRobots));
+    engine.aheadWaiting = true;
+    engine.aheadReady.notify_one();
+}
+
+
+//-------------------------------------------------------------------------------------
+// searchAhead()
+//      The helper thread: search from the latest position given to prepareHints(),
+//      then from every move out of it, until a new position is given.  A search
+//      interrupted by findHint() is tried again once the hint is found.
+//
+void searchAhead( HintEngine &engine)
+{
+    int robots[ NUMBER_OF_ROBOTS + 1];
+    while( true) {
+        {
+            unique_lock< mutex> hold( engine.aheadLock);
+            engine.aheadReady.wait( hold, [&]() { return engine.aheadWaiting || engine.quitting; });
+            if( engine.quitting) {
+                return;
+            }
+            memcpy( robots, engine.aheadRobots, sizeof( robots));
+            engine.aheadWaiting = false;
+        }
+
+        // position 0 is the one given, and 1..MAX_SUCCESSORS the moves from it
+        StateKey successors[ MAX_SUCCESSORS];
+        unsigned char successorMoves[ MAX_SUCCESSORS];
+        int count = -1;
+        for( int i=0; (count < 0) || (i <= count); ) {
+            {
+                lock_guard< mutex> hold( engine.aheadLock);
+                if( engine.aheadWaiting || engine.quitting) {
+                    break;       // the player has moved on
+                }
+            }
+            if( engine.interrupt) {
+                this_thread::yield();       // a hint is waiting for searchLock
+                continue;
+            }
+            lock_guard< mutex> hold( engine.searchLock);
+            if( count < 0) {
+                count = generateSuccessors( *engine.board, packRobots( robots), successors, successorMoves);
+            }
+            int position[ NUMBER_OF_ROBOTS + 1];
+            position[ 0] = 0;
+            for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+                position[ robot] = (i == 0) ? robots[ robot] : robotPosition( successors[ i-1], robot);
+            }
+            int movesLeft;
+            SolverMove move;
+            searchHint( engine, position, movesLeft, move);
+            if( !engine.interrupt) {
+                i++;
+            }
+        }
+    }
+}//end searchAhead()
+
+
+HintEngine::HintEngine() : board( NULL), goalRobot( 0), goalPosition( -1), interrupt( false),
+                           aheadWaiting( false), quitting( false)
+{
+    context.knownStates = &known;
+    context.interrupt = &interrupt;
+    helper = thread( searchAhead, ref( *this));
+}
+
+HintEngine::~HintEngine()
+{
+    {
+        lock_guard< mutex> hold( aheadLock);
+        quitting = true;
+        aheadReady.notify_one();
+    }
+    interrupt = true;               // cut short any search
+    helper.join();
+}
+
+
+//-------------------------------------------------------------------------------------
+// playGame() - allow user to make moves, until they quit or reach the goal
+//
+void playGame( Game &game,               // game to play, already set up by startGame()
+              Renderer &renderer,        // draws the board after each move
+              const char *recordFileName) // game record file a finished game is added to, or NULL
+{
+    int moveNumber = 1;          // number of the next move; moves that move nothing don't count
+    char robot = ' ';            // user entry for robot to move
+    char moveDirection = ' ';    // direction in which to move (L, U, R, or D)
+    int directionOffset = 0;    // value to add to current robot position to reflect move direction
+    int direction = 0;          // index of moveDirection in DIRECTION_LETTERS
+    int destination = 0;        // square where the moving robot will stop
+    const Board &board = *game.board;
+    unique_ptr< HintEngine> hints;   // made the first time a hint is asked for
+
+    // display board.  Only the destination letter is shown, to make playing the game more clear
+    displayBoard( game.goalRobot, game.destinationLetter, board, game.robots);
+
+    // infinite loop to play the game
+    while( true) {
+        moveNumber = gameMovesMade( game) + 1;
+        cout << moveNumber << ". Please enter the robot to move and the direction (e.g. 2 r): ";
+        // handle input of robot, (or 'X' to exit, 'U' to undo, 'R' to redo or 'H' for a hint)
+        cin >> robot;
+        if( toupper( robot) == 'X') {
+            break;      // exit program   
+        }
+        // Give a hint: how many moves are left, and a move to make.  It is displayed
+        // after the board, like the undo and redo messages.
+        if( toupper( robot) == 'H') {
+            if( !hints) {
+                hints.reset( new HintEngine);
+            }
+            int movesLeft;
+            SolverMove move;
+            bool solved = findHint( *hints, game, movesLeft, move);
+            prepareHints( *hints, game);    // search ahead while the player thinks
+            renderBoard( renderer, game.goalRobot, game.destinationLetter, board, game.robots);
+            if( !solved) {
+                cout << "*** No solution of " << DEFAULT_MAX_SOLUTION_MOVES << " moves or less from here.  Try undoing some moves. " << endl << endl;
+            }
+            else {
+                cout << "Hint: " << movesLeft << " moves left.  Try " << move.robot << " " << move.direction << endl << endl;
+            }
+            continue;    // go back up and prompt for next move
+        }
+        // Handle undoing or redoing a move.  The error message for having nothing to
+        // undo or redo is displayed after the board, not before the board.
+        if( (toupper( robot) == 'U') || (toupper( robot) == 'R')) {
+            bool done = (toupper( robot) == 'U') ? undoGameMove( game) : redoGameMove( game);
+            if( hints) {
+                prepareHints( *hints, game);
+            }
+            renderBoard( renderer, game.goalRobot, game.destinationLetter, board, game.robots);
+
+            // Display error message if there is no history to use
+            if( !done && (toupper( robot) == 'U')) {
+                  cout << "*** Can't undo past the beginning of the game.  Please retry move. " << endl << endl;
+            }
+            else if( !done) {
+                  cout << "*** There is no undone move to redo.  Please retry move. " << endl << endl;
+            }
+            continue;    // go back up and prompt for next move
+        }
+        cin >> moveDirection;
+        moveDirection = toupper( moveDirection);  // fold into upper-case
+        // ensure robot values were in range
+        if( (robot < '1') || (robot > NUMBER_OF_ROBOTS+'0')) {
+            cout << "Invalid robot value, please retry." << endl;
+            continue;  // continue up to the user input loop again   
+        }
+
+        // Find the directionOffset for robot change in position
+        switch( moveDirection) {
+            case 'L': directionOffset = -1; direction = LEFT; break;
+            case 'U': directionOffset = -BOARD_EDGE; direction = ABOVE; break;
+            case 'R': directionOffset = 1; direction = RIGHT; break;
+            case 'D': directionOffset = BOARD_EDGE; direction = BELOW; break;
+            default: cout << "*** Error, invalid direction.  Retry Input. \n" << endl;
+                continue;  // continue up to the user input loop again
+        } 
+
+        // Make the move, then show the piece sliding there one square at a time, on a
+        // copy of the robots.  Without animation it goes straight there.
+        int shown[ NUMBER_OF_ROBOTS + 1];
+        memcpy( shown, game.robots, sizeof( shown));
+        destination = makeGameMove( game, robot-'0', direction);
+        if( hints) {
+            prepareHints( *hints, game);
+        }
+        while( renderer.animate && (shown[ robot-'0'] != destination)) {
+            // move the robot one square.  Must subtract '0' from robot since it's a char
+            shown[ robot-'0'] += directionOffset;
+            renderBoard( renderer, game.goalRobot, game.destinationLetter, board, shown);
+        }
+        if( !renderer.animate) {
+            renderBoard( renderer, game.goalRobot, game.destinationLetter, board, game.robots);
+        }
+
+        // See if we've arrived at destination.  We've arrived if the robot just moved
+        // was the goal robot, and it's location is the goal position
+        if( ((robot-'0') == game.goalRobot) && goalReached( game)) {
+            cout << "Great Job!  You did it in only " << gameMovesMade( game) << " moves." << endl;
+            if( (recordFileName != NULL) && !appendGameRecord( recordFileName, game)) {
+                cout << "*** The game could not be added to " << recordFileName << "." << endl;
+            }
+            break;        // break from endless loop making moves 
+        }                                                             
+    }//end while( true...
+
+}// end playGame()
+
+
+//-------------------------------------------------------------------------------------
+// peakMemoryKilobytes() - Largest resident memory of the process so far, 0 if unknown
+//
+long peakMemoryKilobytes()
+{
+    long peakKilobytes = 0;
+#if !defined( _WIN32)
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage) == 0) {
+        peakKilobytes = usage.ru_maxrss;
+#if defined( __APPLE__)
+        peakKilobytes /= 1024;          // reported in bytes on macOS
+#endif
+    }
+#endif
+    return peakKilobytes;
+}
+
+
+//-------------------------------------------------------------------------------------
+// writeStatsJson()
+//      Write the statistics from a solve as one JSON object:
+//
+//          {"search":"bfs","expanded":7251,"generated":...,"hash_load":0.11,
+//           "depths":[{"depth":0,"expanded":1,...},...],"iterations":[...]}
+//
+void writeStatsJson( ostream &out, const SolverStats &stats)
+{
+    out << "{\"search\":\"" << stats.search << "\",\"expanded\":" << stats.expanded
+        << ",\"generated\":" << stats.generated << ",\"duplicates\":" << stats.duplicates
+        << ",\"pruned\":" << stats.pruned << ",\"hash_lookups\":" << stats.hashLookups
+        << ",\"average_probe\":" << (stats.hashLookups > 0 ? (double)stats.hashProbes / stats.hashLookups : 0.0)
+        << ",\"longest_probe\":" << stats.longestProbe << ",\"hash_load\":" << stats.hashLoad
+        << ",\"peak_bytes\":" << stats.peakBytes << ",\"disk_bytes\":" << stats.diskBytes
+        << ",\"peak_rss_kb\":" << peakMemoryKilobytes()
+        << ",\"microseconds\":" << stats.microseconds << ",\"depths\":[";
+    for( size_t i=0; i<stats.depths.size(); i++) {
+        const DepthStats &depth = stats.depths[ i];
+        out << (i > 0 ? "," : "") << "{\"depth\":" << i << ",\"expanded\":" << depth.expanded
+            << ",\"generated\":" << depth.generated << ",\"duplicates\":" << depth.duplicates
+            << ",\"pruned\":" << depth.pruned << ",\"microseconds\":" << depth.microseconds << "}";
+    }
+    out << "],\"iterations\":[";
+    for( size_t i=0; i<stats.iterations.size(); i++) {
+        const IterationStats &iteration = stats.iterations[ i];
+        out << (i > 0 ? "," : "") << "{\"bound\":" << iteration.bound << ",\"expanded\":" << iteration.expanded
+            << ",\"microseconds\":" << iteration.microseconds << "}";
+    }
+    out << "]}" << endl;
+}//end writeStatsJson()
+
+
+//-------------------------------------------------------------------------------------
+// writeStatsTrace()
+//      Write the statistics from a solve in Chrome trace event format, for loading
+//      into chrome://tracing or Perfetto.  Each breadth-first depth or IDA* iteration
+//      is a span with its counts as arguments, and the states expanded are also a
+//      counter track.
+//
+void writeStatsTrace( ostream &out, const SolverStats &stats)
+{
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"solve " << stats.search << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":0,\"dur\":"
+        << stats.microseconds << ",\"args\":{\"expanded\":" << stats.expanded << ",\"peak_bytes\":"
+        << stats.peakBytes << ",\"disk_bytes\":" << stats.diskBytes << "}}";
+    // breadth-first depths are timed, IDA* depths are spread over its iterations
+    for( size_t i=0; (i < stats.depths.size()) && stats.iterations.empty(); i++) {
+        const DepthStats &depth = stats.depths[ i];
+        out << ",\n{\"name\":\"depth " << i << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+            << depth.startMicroseconds << ",\"dur\":" << depth.microseconds << ",\"args\":{\"expanded\":"
+            << depth.expanded << ",\"generated\":" << depth.generated << ",\"duplicates\":"
+            << depth.duplicates << "}}";
+        out << ",\n{\"name\":\"frontier\",\"ph\":\"C\",\"pid\":1,\"ts\":" << depth.startMicroseconds
+            << ",\"args\":{\"states\":" << depth.expanded << "}}";
+    }
+    for( size_t i=0; i<stats.iterations.size(); i++) {
+        const IterationStats &iteration = stats.iterations[ i];
+        out << ",\n{\"name\":\"bound " << iteration.bound << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+            << iteration.startMicroseconds << ",\"dur\":" << iteration.microseconds
+            << ",\"args\":{\"expanded\":" << iteration.expanded << "}}";
+        out << ",\n{\"name\":\"expanded\",\"ph\":\"C\",\"pid\":1,\"ts\":" << iteration.startMicroseconds
+            << ",\"args\":{\"states\":" << iteration.expanded << "}}";
+    }
+    out << "\n]}" << endl;
+}//end writeStatsTrace()
+
+
+//-------------------------------------------------------------------------------------
+// WorkerPool
+//      A fixed set of threads that all run the same job together.  run() calls
+//      job( worker) once on each worker, numbered 0..size()-1, and returns when they
+//      have all finished.  Worker 0 is the calling thread.  Jobs share out their work
+//      by taking chunks from an atomic counter with takeChunk(), so a worker that
+//      finishes early takes over chunks that would otherwise wait for a busy one.
+//
+class WorkerPool {
+public:
+    explicit WorkerPool( int threadCount = 0);     // 0 means one per hardware thread
+    ~WorkerPool();
+    int size() const { return (int)threads.size() + 1; }
+    void run( const function< void( int)> &job);
+
+private:
+    void workerLoop( int worker);
+
+    vector< thread> threads;              // background workers 1..size()-1
+    mutex poolMutex;                      // protects everything below
+    condition_variable jobReady;          // signalled when a job is posted, or on shutdown
+    condition_variable jobFinished;       // signalled when the last background worker finishes
+    const function< void( int)> *currentJob;
+    long jobNumber;                       // incremented for each job posted
+    int workersBusy;                      // background workers still running the current job
+    bool shuttingDown;
+};
+
+WorkerPool::WorkerPool( int threadCount)
+    : currentJob( NULL), jobNumber( 0), workersBusy( 0), shuttingDown( false)
+{
+    if( threadCount <= 0) {
+        threadCount = max( 1, (int)thread::hardware_concurrency());
+    }
+    for( int worker=1; worker<threadCount; worker++) {
+        threads.push_back( thread( &WorkerPool::workerLoop, this, worker));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard< mutex> guard( poolMutex);
+        shuttingDown = true;
+    }
+    jobReady.notify_all();
+    for( size_t i=0; i<threads.size(); i++) {
+        threads[ i].join();
+    }
+}
+
+void WorkerPool::run( const function< void( int)> &job)
+{
+    {
+        lock_guard< mutex> guard( poolMutex);
+        currentJob = &job;
+        workersBusy = (int)threads.size();
+        jobNumber++;
+    }
+    jobReady.notify_all();
+    job( 0);                    // the calling thread is worker 0
+
+    unique_lock< mutex> guard( poolMutex);
+    jobFinished.wait( guard, [this] { return workersBusy == 0; });
+    currentJob = NULL;
+}
+
+void WorkerPool::workerLoop( int worker)
+{
+    long jobsSeen = 0;
+    while( true) {
+        const function< void( int)> *job;
+        {
+            unique_lock< mutex> guard( poolMutex);
+            jobReady.wait( guard, [&] { return shuttingDown || (jobNumber != jobsSeen); });
+            if( shuttingDown) {
+                return;
+            }
+            jobsSeen = jobNumber;
+            job = currentJob;
+        }
+        (*job)( worker);
+        {
+            lock_guard< mutex> guard( poolMutex);
+            workersBusy--;
+            if( workersBusy == 0) {
+                jobFinished.notify_one();
+            }
+        }
+    }
+}//end WorkerPool
+
+
+//-------------------------------------------------------------------------------------
+// takeChunk()
+//      Claim the next chunk of work items from a shared counter.  Sets begin and end to
+//      the items claimed and returns false once all total items are taken.
+//
+inline bool takeChunk( atomic< size_t> &nextItem, size_t total, size_t chunkSize, size_t &begin, size_t &end)
+{
+    begin = nextItem.fetch_add( chunkSize, memory_order_relaxed);
+    if( begin >= total) {
+        return false;
+    }
+    end = min( begin + chunkSize, total);
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// atomicMin()
+//      Lower an atomic value to candidate, if candidate is smaller
+//
+inline void atomicMin( atomic< size_t> &value, size_t candidate)
+{
+    size_t current = value.load( memory_order_relaxed);
+    while( (candidate < current) &&
+           !value.compare_exchange_weak( current, candidate, memory_order_relaxed)) {
+        // current was reloaded by the failed exchange, so just try again
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Parallel solver
+//      solvePuzzleParallel() expands each breadth-first level across a WorkerPool.
+//      The visited set is a lock-free hash table: a worker claims an empty slot for a
+//      new key with compare-and-swap.  Next to each key is its origin, the lowest
+//      (parent index * MAX_SUCCESSORS + move) that reached it in the level being built,
+//      plus 1.  A free slot's origin is UNCLAIMED_ORIGIN, the largest value, so the
+//      worker that claims a key and any worker that reaches the same key before the
+//      claimant has written its origin all lower it with atomicMin(), and the lowest
+//      wins whatever the order.  Origins are set to 0 once the level is finished, so
+//      states from earlier levels are never taken as new.
+//
+//      solvePuzzle() keeps the first way it reaches each state, and finds new states
+//      in origin order.  Sorting each new level by origin, and taking the goal state
+//      with the lowest origin, therefore gives exactly the same solution however many
+//      threads are used.  Sorting is done by writing each new state at its origin in
+//      childAt, then packing childAt down in parallel.
+//
+//      Memory: childAt has MAX_SUCCESSORS entries for every state of the frontier, 16
+//      keys per state with 4 robots, so expanding a level of n states takes 16 n keys
+//      on top of the visited table (a key and a size_t origin per slot, at most 3/4
+//      full) and each level's keys and origins.  Origins are size_t, so a level can be
+//      as large as memory allows.
+//
+const size_t PARALLEL_CHUNK = 256;          // states taken by a worker at a time
+const size_t UNCLAIMED_ORIGIN = ~(size_t)0; // origin of a free visited slot
+
+struct ParallelSolverContext {
+    unique_ptr< atomic< StateKey>[]> visitedKeys;     // hash set of keys reached, 0 marks an empty slot
+    unique_ptr< atomic< size_t>[]> visitedOrigins;    // origin of each key, see above
+    uint32_t visitedMask;                             // table size - 1.  The size is a power of 2.
+    size_t visitedCount;                              // number of keys in the table
+    vector< vector< StateKey>> levelKeys;             // states at each depth, in solvePuzzle() order
+    vector< vector< size_t>> levelOrigins;            // parent index * MAX_SUCCESSORS + move of each state
+    vector< vector< uint32_t>> claimedSlots;          // per worker: slots it claimed in this level
+    vector< StateKey> childAt;                        // new states of this level, by origin
+    vector< size_t> chunkCounts;                      // new states in each chunk of childAt
+    atomic< long> statesExpanded;                     // number of states expanded by the last solve
+    bool collectStats;                                // fill in stats on each solve, see SolverStats
+    SolverStats stats;                                // statistics for the last solve, if collectStats is set
+
+    ParallelSolverContext() : visitedMask( 0), visitedCount( 0), statesExpanded( 0), collectStats( false) { }
+};
+
+
+//-------------------------------------------------------------------------------------
+// reserveParallelVisited()
+//      Make sure the visited table can take another additional keys while staying at
+//      most 3/4 full.  Between levels every key in the table is finished (origin 0)
+//      and every free slot is UNCLAIMED_ORIGIN, so growing only has to move the keys.
+//
+void reserveParallelVisited( ParallelSolverContext &context, size_t additional)
+{
+    size_t size = context.visitedKeys ? (size_t)context.visitedMask + 1 : 0;
+    size_t needed = context.visitedCount + additional;
+    if( needed * 4 <= size * 3) {
+        return;
+    }
+    size_t newSize = 1 << 16;
+    while( needed * 4 > newSize * 3) {
+        newSize *= 2;
+    }
+    unique_ptr< atomic< StateKey>[]> newKeys( new atomic< StateKey>[ newSize]);
+    unique_ptr< atomic< size_t>[]> newOrigins( new atomic< size_t>[ newSize]);
+    uint32_t newMask = (uint32_t)(newSize - 1);
+    for( size_t i=0; i<newSize; i++) {
+        newKeys[ i].store( 0, memory_order_relaxed);
+        newOrigins[ i].store( UNCLAIMED_ORIGIN, memory_order_relaxed);
+    }
+    for( size_t i=0; i<size; i++) {
+        StateKey key = context.visitedKeys[ i].load( memory_order_relaxed);
+        if( key != 0) {
+            uint32_t slot = hashSlot( key, newMask);
+            while( newKeys[ slot].load( memory_order_relaxed) != 0) {
+                slot = (slot + 1) & newMask;
+            }
+            newKeys[ slot].store( key, memory_order_relaxed);
+            newOrigins[ slot].store( 0, memory_order_relaxed);
+        }
+    }
+    context.visitedKeys.swap( newKeys);
+    context.visitedOrigins.swap( newOrigins);
+    context.visitedMask = newMask;
+}//end reserveParallelVisited()
+
+
+//-------------------------------------------------------------------------------------
+// parallelVisit()
+//      Record that key was reached from origin in the level being built.  If the key
+//      is new, its slot is added to the worker's claimed list.
+//
+inline void parallelVisit( ParallelSolverContext &context, int worker, StateKey key, size_t origin)
+{
+    uint32_t slot = hashSlot( key, context.visitedMask);
+    while( true) {
+        StateKey current = context.visitedKeys[ slot].load( memory_order_relaxed);
+        if( current == 0) {
+            // try to claim the empty slot.  If another worker got there first, look
+            // at what it stored, since it may be this same key.  Another worker may
+            // already have lowered the origin of a slot just claimed, so the claimant
+            // lowers it too, rather than storing over it.
+            if( context.visitedKeys[ slot].compare_exchange_strong( current, key, memory_order_relaxed)) {
+                atomicMin( context.visitedOrigins[ slot], origin);
+                context.claimedSlots[ worker].push_back( slot);
+                return;
+            }
+        }
+        if( current == key) {
+            // already there.  This does nothing if the key is from an earlier level.
+            atomicMin( context.visitedOrigins[ slot], origin);
+            return;
+        }
+        slot = (slot + 1) & context.visitedMask;
+    }
+}//end parallelVisit()
+
+
+//-------------------------------------------------------------------------------------
+// solvePuzzleParallel()
+//      Multi-threaded version of solvePuzzle(), with the same parameters and results,
+//      using all the workers in pool.
+//
+bool solvePuzzleParallel( ParallelSolverContext &context,                // reusable scratch memory
+                          WorkerPool &pool,                              // threads to search with
+                          const Board &board,                            // compiled board to solve on
+                          const int startRobots[ NUMBER_OF_ROBOTS + 1],  // robot positions, theRobots layout
+                          int goalRobot,                                 // robot that needs to reach destination
+                          int goalPosition,                              // square it has to stop on
+                          int maxMoves,                                  // longest solution to look for
+                          vector<SolverMove> &solution)                  // returns the moves found
+{
+    // reset the scratch memory, keeping the table if it is already allocated.  A
+    // solve that found its goal left the origins of its last level behind.
+    size_t tableSize = context.visitedKeys ? (size_t)context.visitedMask + 1 : 0;
+    for( size_t i=0; i<tableSize; i++) {
+        context.visitedKeys[ i].store( 0, memory_order_relaxed);
+        context.visitedOrigins[ i].store( UNCLAIMED_ORIGIN, memory_order_relaxed);
+    }
+    context.visitedCount = 0;
+    context.levelKeys.clear();
+    context.levelOrigins.clear();
+    context.claimedSlots.assign( pool.size(), vector< uint32_t>());
+    context.statesExpanded = 0;
+    solution.clear();
+    bool collectStats = SOLVER_STATS_ENABLED && context.collectStats;
+    chrono::steady_clock::time_point solveStart = chrono::steady_clock::now();
+    auto finishStats = [&]() {
+        SolverStats &stats = context.stats;
+        addUpDepthStats( stats);
+        size_t slots = (size_t)context.visitedMask + 1;
+        size_t keys = context.visitedCount;          // and the keys of a level not finished
+        for( size_t worker=0; worker<context.claimedSlots.size(); worker++) {
+            keys += context.claimedSlots[ worker].size();
+        }
+        stats.hashLoad = (double)keys / slots;
+        stats.peakBytes = slots * (sizeof( StateKey) + sizeof( size_t)) + context.childAt.capacity() * sizeof( StateKey);
+        for( size_t level=0; level<context.levelKeys.size(); level++) {
+            stats.peakBytes += context.levelKeys[ level].capacity() * sizeof( StateKey) +
+                               context.levelOrigins[ level].capacity() * sizeof( size_t);
+        }
+        stats.microseconds = microsecondsSince( solveStart);
+    };
+    if( collectStats) {
+        resetSolverStats( context.stats, "parallel");
+    }
+
+    if( startRobots[ goalRobot] == goalPosition) {
+        return true;       // nothing to do
+    }
+    StateKey startKey = canonicalKey( packRobots( startRobots), goalRobot);
+    reserveParallelVisited( context, 1);
+    parallelVisit( context, 0, startKey, 0);
+    context.claimedSlots[ 0].clear();
+    context.visitedCount = 1;
+    context.levelKeys.push_back( vector< StateKey>( 1, startKey));
+    context.levelOrigins.push_back( vector< size_t>( 1, 0));
+
+    const size_t NOT_FOUND = UNCLAIMED_ORIGIN;
+    for( int depth=0; depth<maxMoves; depth++) {
+        const vector< StateKey> &frontier = context.levelKeys[ depth];
+        size_t frontierSize = frontier.size();
+        if( frontierSize == 0) {
+            break;     // every reachable state has been seen
+        }
+        if( collectStats) {
+            depthStats( context.stats, depth).startMicroseconds = microsecondsSince( solveStart);
+        }
+        reserveParallelVisited( context, frontierSize * MAX_SUCCESSORS);
+        context.childAt.assign( frontierSize * MAX_SUCCESSORS, 0);
+
+        // expand every state of the level
+        atomic< size_t> nextState( 0);
+        atomic< size_t> goalOrigin( NOT_FOUND);
+        atomic< long> levelGenerated( 0);
+        pool.run( [&]( int worker) {
+            size_t begin, end;
+            long expanded = 0;
+            long generated = 0;
+            while( takeChunk( nextState, frontierSize, PARALLEL_CHUNK, begin, end)) {
+                for( size_t index=begin; index<end; index++) {
+                    StateKey successors[ MAX_SUCCESSORS];
+                    unsigned char successorMoves[ MAX_SUCCESSORS];
+                    int count = generateSuccessors( board, frontier[ index], successors, successorMoves);
+                    generated += count;
+                    for( int i=0; i<count; i++) {
+                        size_t origin = index * MAX_SUCCESSORS + successorMoves[ i];
+                        successors[ i] = canonicalKey( successors[ i], goalRobot);
+                        parallelVisit( context, worker, successors[ i], origin + 1);
+                        if( robotPosition( successors[ i], goalRobot) == goalPosition) {
+                            atomicMin( goalOrigin, origin);
+                        }
+                    }
+                }
+                expanded += end - begin;
+            }
+            context.statesExpanded += expanded;
+            levelGenerated += generated;
+        });
+        if( collectStats) {
+            // every successor that didn't claim a slot was already reached
+            long newStates = 0;
+            for( size_t worker=0; worker<context.claimedSlots.size(); worker++) {
+                newStates += (long)context.claimedSlots[ worker].size();
+            }
+            DepthStats &level = context.stats.depths[ depth];
+            level.expanded = (long)frontierSize;
+            level.generated = levelGenerated;
+            level.duplicates = levelGenerated - newStates;
+        }
+
+        if( goalOrigin != NOT_FOUND) {
+            // walk back through the levels, then reverse to get the moves in order
+            vector< pair< StateKey, int>> moves;
+            size_t origin = goalOrigin;
+            for( int level=depth; level>=0; level--) {
+                moves.push_back( make_pair( context.levelKeys[ level][ origin / MAX_SUCCESSORS],
+                                            (int)(origin % MAX_SUCCESSORS)));
+                origin = context.levelOrigins[ level][ origin / MAX_SUCCESSORS];
+            }
+            reverse( moves.begin(), moves.end());
+            canonicalMovesToSolution( board, startRobots, moves, solution);
+            if( collectStats) {
+                DepthStats &level = context.stats.depths[ depth];
+                level.microseconds = microsecondsSince( solveStart) - level.startMicroseconds;
+                finishStats();
+            }
+            return true;
+        }
+
+        // place each new state at its origin, and mark its level finished
+        pool.run( [&]( int worker) {
+            vector< uint32_t> &claimed = context.claimedSlots[ worker];
+            for( size_t i=0; i<claimed.size(); i++) {
+                uint32_t slot = claimed[ i];
+                size_t origin = context.visitedOrigins[ slot].load( memory_order_relaxed) - 1;
+                context.childAt[ origin] = context.visitedKeys[ slot].load( memory_order_relaxed);
+                context.visitedOrigins[ slot].store( 0, memory_order_relaxed);
+            }
+            claimed.clear();
+        });
+
+        // pack childAt into the next level: count each chunk, then copy to its offset
+        size_t chunkSize = PARALLEL_CHUNK * MAX_SUCCESSORS;
+        size_t chunks = (context.childAt.size() + chunkSize - 1) / chunkSize;
+        context.chunkCounts.assign( chunks + 1, 0);
+        atomic< size_t> nextChunk( 0);
+        pool.run( [&]( int) {
+            size_t begin, end;
+            while( takeChunk( nextChunk, chunks, 1, begin, end)) {
+                size_t last = min( (begin + 1) * chunkSize, context.childAt.size());
+                size_t found = 0;
+                for( size_t i=begin * chunkSize; i<last; i++) {
+                    found += (context.childAt[ i] != 0);
+                }
+                context.chunkCounts[ begin + 1] = found;
+            }
+        });
+        for( size_t chunk=0; chunk<chunks; chunk++) {
+            context.chunkCounts[ chunk + 1] += context.chunkCounts[ chunk];
+        }
+        size_t levelSize = context.chunkCounts[ chunks];
+        context.levelKeys.push_back( vector< StateKey>( levelSize));
+        context.levelOrigins.push_back( vector< size_t>( levelSize));
+        vector< StateKey> &nextKeys = context.levelKeys.back();
+        vector< size_t> &nextOrigins = context.levelOrigins.back();
+        nextChunk = 0;
+        pool.run( [&]( int) {
+            size_t begin, end;
+            while( takeChunk( nextChunk, chunks, 1, begin, end)) {
+                size_t last = min( (begin + 1) * chunkSize, context.childAt.size());
+                size_t out = context.chunkCounts[ begin];
+                for( size_t i=begin * chunkSize; i<last; i++) {
+                    if( context.childAt[ i] != 0) {
+                        nextKeys[ out] = context.childAt[ i];
+                        nextOrigins[ out] = i;
+                        out++;
+                    }
+                }
+            }
+        });
+        context.visitedCount += levelSize;
+        if( collectStats) {
+            DepthStats &level = context.stats.depths[ depth];
+            level.microseconds = microsecondsSince( solveStart) - level.startMicroseconds;
+        }
+    }
+    if( collectStats) {
+        finishStats();
+    }
+    return false;
+}//end solvePuzzleParallel()
+
+
+//-------------------------------------------------------------------------------------
+// Compact solver
+//      solvePuzzleCompact() is a breadth-first search whose only record of the states
+//      it has reached is a 2-bit value per packed state key: 0 if the state has not
+//      been reached, otherwise (depth % 3) + 1.  With four robots there are 2^32 keys,
+//      so the whole array would be 1 GB.  It is kept in pages of COMPACT_PAGE_STATES
+//      states, allocated when a state in them is first reached, so the memory used
+//      grows with the part of the state space the search touches and can never pass
+//      that 1 GB ceiling.  There is no frontier list and no parent link: each depth is
+//      expanded by scanning the pages for states marked with that depth.  States from
+//      three depths earlier have the same mark and are expanded again, but by then
+//      everything they lead to has been reached, so that costs time and not memory.
+//
+//      The moves are recovered afterwards by walking back from the goal state with
+//      generatePredecessors().  A predecessor marked one depth less is normally one
+//      depth less, but in a puzzle where moves can't be undone it may be three depths
+//      more instead.  So the walk back is a depth-first search that backs out of a
+//      predecessor that can't be followed back to the start, and remembers the states
+//      it has backed out of.  Any chain it finds has the length of a shortest solution,
+//      so it is one.
+//
+//      Only builds with 4 robots or fewer have a 32-bit key space that can be paged
+//      like this.
+//
+const int COMPACT_PAGE_BITS = 12;
+const uint32_t COMPACT_PAGE_STATES = 1 << COMPACT_PAGE_BITS;    // states per page, 1 KB
+const int COMPACT_PAGE_WORDS = COMPACT_PAGE_STATES / 32;        // 32 states in each 64-bit word
+const bool COMPACT_SOLVER_AVAILABLE = (NUMBER_OF_ROBOTS <= 4);
+const int COMPACT_PAGE_COUNT = COMPACT_SOLVER_AVAILABLE ? (int)(((uint64_t)1 << (8 * NUMBER_OF_ROBOTS)) >> COMPACT_PAGE_BITS) : 0;
+const int MAX_PREDECESSORS = NUMBER_OF_ROBOTS * NUMBER_OF_DIRECTIONS * (BOARD_EDGE - 1);
+
+struct CompactSolverContext {
+    vector< unique_ptr< uint64_t[]>> pages;   // COMPACT_PAGE_COUNT pages of 2-bit depth marks, NULL until used
+    vector< uint32_t> pageDepths;             // bit d is set if the page has a state first reached at depth d
+    vector< uint32_t> pagesInUse;             // numbers of the pages allocated, in the order they were
+    long statesExpanded;                      // number of states expanded by the last solve
+    bool collectStats;                        // fill in stats on each solve, see SolverStats
+    SolverStats stats;                        // statistics for the last solve, if collectStats is set
+
+    CompactSolverContext() : statesExpanded( 0), collectStats( false) { }
+};
+
+
+//-------------------------------------------------------------------------------------
+// compactMark() and setCompactMark()
+//      Read the 2-bit mark of a state, and mark a state as first reached at depth.
+//
+inline int compactMark( const CompactSolverContext &context, StateKey key)
+{
+    const uint64_t *page = context.pages[ key >> COMPACT_PAGE_BITS].get();
+    if( page == NULL) {
+        return 0;
+    }
+    uint32_t index = (uint32_t)key & (COMPACT_PAGE_STATES - 1);
+    return (int)(page[ index >> 5] >> (2 * (index & 31))) & 3;
+}
+
+inline void setCompactMark( CompactSolverContext &context, StateKey key, int depth)
+{
+    uint32_t pageNumber = (uint32_t)(key >> COMPACT_PAGE_BITS);
+    unique_ptr< uint64_t[]> &page = context.pages[ pageNumber];
+    if( !page) {
+        page.reset( new uint64_t[ COMPACT_PAGE_WORDS]());
+        context.pagesInUse.push_back( pageNumber);
+    }
+    uint32_t index = (uint32_t)key & (COMPACT_PAGE_STATES - 1);
+    page[ index >> 5] |= (uint64_t)(depth % 3 + 1) << (2 * (index & 31));
+    context.pageDepths[ pageNumber] |= 1u << depth;
+}
+
+
+//-------------------------------------------------------------------------------------
+// generatePredecessors()
+//      Fill in the canonical states that reach key in one move, with the move that
+//      does it as (robot-1)*4 + direction, where the robot is numbered by its byte in
+//      the predecessor's key.  A robot can only have ended a slide on its square if
+//      the way on is blocked by a wall or robot, and it can have started from any
+//      square back along its path up to the nearest wall or robot.
+//      Returns the number of predecessors.
+//
+int generatePredecessors( const Board &board,                              // board walls
+                          StateKey key,                                    // canonical state to move to
+                          int goalRobot,                                   // robot that is kept in its own byte
+                          StateKey predecessors[ MAX_PREDECESSORS],        // returns the states
+                          unsigned char moveCodes[ MAX_PREDECESSORS])      // returns the moves
+{
+    Bitboard occupancy;
+    bitboardClear( occupancy);
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        bitboardSet( occupancy, robotPosition( key, robot));
+    }
+
+    int count = 0;
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        int to = robotPosition( key, robot);
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            int offset = DIRECTION_OFFSETS[ direction];
+            if( !bitboardTest( board.walls[ direction], to) && !bitboardTest( occupancy, to + offset)) {
+                continue;      // a robot moving this way would not have stopped here
+            }
+            int back = OPPOSITE_DIRECTION[ direction];
+            for( int from=to; !bitboardTest( board.walls[ back], from) && !bitboardTest( occupancy, from - offset); ) {
+                from -= offset;
+                StateKey predecessor = canonicalKey( (key & ~((StateKey)0xFF << (8 * (robot-1)))) |
+                                                     ((StateKey)from << (8 * (robot-1))), goalRobot);
+                int slot = 1;
+                while( robotPosition( predecessor, slot) != from) {
+                    slot++;
+                }
+                predecessors[ count] = predecessor;
+                moveCodes[ count] = (unsigned char)((slot-1) * NUMBER_OF_DIRECTIONS + direction);
+                count++;
+            }
+        }
+    }
+    return count;
+}//end generatePredecessors()
+
+
+//-------------------------------------------------------------------------------------
+// compactWalkBack()
+//      Find a chain of depth moves from startKey to key, through states marked with
+//      each depth on the way, and append its moves (canonical state and move code, as
+//      for canonicalMovesToSolution()) to moves in order.  failed holds the states,
+//      with their depth, that have already been found to lead nowhere.
+//
+bool compactWalkBack( const CompactSolverContext &context,
+                      const Board &board,
+                      StateKey startKey,                       // canonical start state
+                      StateKey key,                            // canonical state to reach
+                      int depth,                               // moves to reach it in
+                      int goalRobot,
+                      unordered_set< uint64_t> &failed,
+                      vector< pair< StateKey, int>> &moves)
+{
+    if( depth == 0) {
+        return key == startKey;
+    }
+    uint64_t failedKey = ((uint64_t)key << 5) | (uint64_t)depth;       // depths are under 32
+    if( failed.count( failedKey) > 0) {
+        return false;
+    }
+    StateKey predecessors[ MAX_PREDECESSORS];
+    unsigned char moveCodes[ MAX_PREDECESSORS];
+    int count = generatePredecessors( board, key, goalRobot, predecessors, moveCodes);
+    for( int i=0; i<count; i++) {
+        if( (compactMark( context, predecessors[ i]) == (depth - 1) % 3 + 1) &&
+            compactWalkBack( context, board, startKey, predecessors[ i], depth - 1, goalRobot, failed, moves)) {
+            moves.push_back( make_pair( predecessors[ i], (int)moveCodes[ i]));
+            return true;
+        }
+    }
+    failed.insert( failedKey);
+    return false;
+}//end compactWalkBack()
+
+
+//-------------------------------------------------------------------------------------
+// solvePuzzleCompact()
+//      Version of solvePuzzle() that keeps only the 2-bit depth marks described above,
+//      with the same parameters and results, except that maxMoves can be at most 31.
+//      Builds with more than 4 robots can't use it, and it returns false.
+//
+bool solvePuzzleCompact( CompactSolverContext &context,                  // reusable page memory
+                         const Board &board,                             // compiled board to solve on
+                         const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                         int goalRobot,                                  // robot that needs to reach destination
+                         int goalPosition,                               // square it has to stop on
+                         int maxMoves,                                   // longest solution to look for
+                         vector<SolverMove> &solution)                   // returns the moves found
+{
+    // free the pages of the last solve, since this one may touch quite different ones
+    if( context.pages.empty()) {
+        context.pages.resize( COMPACT_PAGE_COUNT);
+        context.pageDepths.assign( COMPACT_PAGE_COUNT, 0);
+    }
+    for( size_t i=0; i<context.pagesInUse.size(); i++) {
+        context.pages[ context.pagesInUse[ i]].reset();
+        context.pageDepths[ context.pagesInUse[ i]] = 0;
+    }
+    context.pagesInUse.clear();
+    context.statesExpanded = 0;
+    solution.clear();
+    bool collectStats = SOLVER_STATS_ENABLED && context.collectStats;
+    chrono::steady_clock::time_point solveStart = chrono::steady_clock::now();
+    if( collectStats) {
+        resetSolverStats( context.stats, "compact");
+    }
+    if( !COMPACT_SOLVER_AVAILABLE) {
+        return false;
+    }
+    if( startRobots[ goalRobot] == goalPosition) {
+        return true;       // nothing to do
+    }
+    maxMoves = min( maxMoves, 31);          // pageDepths has a bit per depth
+
+    StateKey startKey = canonicalKey( packRobots( startRobots), goalRobot);
+    setCompactMark( context, startKey, 0);
+    StateKey goalKey = 0;
+    int goalDepth = 0;
+    for( int depth=0; (depth < maxMoves) && (goalDepth == 0); depth++) {
+        // Expand every state marked with this depth.  States marked while doing so
+        // have the next depth's mark, and any pages they add are skipped.
+        uint64_t mark = (uint64_t)(depth % 3 + 1) * 0x5555555555555555ULL;
+        size_t pageCount = context.pagesInUse.size();
+        bool reachedNew = false;
+        double levelStart = collectStats ? microsecondsSince( solveStart) : 0;
+        long expandedBefore = context.statesExpanded;
+        long generated = 0;
+        long duplicates = 0;
+        for( size_t p=0; (p < pageCount) && (goalDepth == 0); p++) {
+            uint32_t pageNumber = context.pagesInUse[ p];
+            if( (context.pageDepths[ pageNumber] & (1u << depth)) == 0) {
+                continue;
+            }
+            const uint64_t *page = context.pages[ pageNumber].get();
+            for( int word=0; (word < COMPACT_PAGE_WORDS) && (goalDepth == 0); word++) {
+                // low bit of each 2-bit field that equals the mark
+                uint64_t different = page[ word] ^ mark;
+                uint64_t matches = ~(different | (different >> 1)) & 0x5555555555555555ULL;
+                while( (matches != 0) && (goalDepth == 0)) {
+                    int field = lowestBit( matches) >> 1;
+                    matches &= matches - 1;
+                    StateKey key = (StateKey)(((uint64_t)pageNumber << COMPACT_PAGE_BITS) | ((uint32_t)word << 5) | field);
+                    context.statesExpanded++;
+
+                    StateKey successors[ MAX_SUCCESSORS];
+                    unsigned char successorMoves[ MAX_SUCCESSORS];
+                    int count = generateSuccessors( board, key, successors, successorMoves);
+                    generated += count;
+                    for( int i=0; i<count; i++) {
+                        StateKey nextKey = canonicalKey( successors[ i], goalRobot);
+                        if( compactMark( context, nextKey) != 0) {
+                            duplicates++;
+                            continue;      // already reached in as few moves
+                        }
+                        setCompactMark( context, nextKey, depth + 1);
+                        reachedNew = true;
+                        if( robotPosition( nextKey, goalRobot) == goalPosition) {
+                            goalKey = nextKey;
+                            goalDepth = depth + 1;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if( collectStats) {
+            DepthStats &level = depthStats( context.stats, depth);
+            level.expanded = context.statesExpanded - expandedBefore;
+            level.generated = generated;
+            level.duplicates = duplicates;
+            level.startMicroseconds = levelStart;
+            level.microseconds = microsecondsSince( solveStart) - levelStart;
+        }
+        if( !reachedNew) {
+            break;     // every reachable state has been seen
+        }
+    }
+    if( collectStats) {
+        SolverStats &stats = context.stats;
+        addUpDepthStats( stats);
+        stats.hashLoad = (double)context.pagesInUse.size() / max( COMPACT_PAGE_COUNT, 1);     // no pages with 5 robots
+        stats.peakBytes = context.pagesInUse.size() * COMPACT_PAGE_WORDS * sizeof( uint64_t) +
+                          context.pages.size() * sizeof( context.pages[ 0]) +
+                          context.pageDepths.size() * sizeof( uint32_t);
+        stats.microseconds = microsecondsSince( solveStart);
+    }
+    if( goalDepth == 0) {
+        return false;
+    }
+
+    unordered_set< uint64_t> failed;
+    vector< pair< StateKey, int>> moves;
+    if( !compactWalkBack( context, board, startKey, goalKey, goalDepth, goalRobot, failed, moves)) {
+        return false;      // can't happen: the goal state was reached from the start
+    }
+    canonicalMovesToSolution( board, startRobots, moves, solution);
+    return true;
+}//end solvePuzzleCompact()
+
+
+//-------------------------------------------------------------------------------------
+// External-memory solver
+//      solvePuzzleExternal() is a breadth-first search that keeps its states on disk,
+//      for puzzles whose state space is far too big for memory, such as hard puzzles
+//      in the 5 robot game (2^40 keys).  Each depth (layer) is a file of the canonical
+//      keys first reached at that depth, in increasing order, stored as the difference
+//      from the key before in a variable-length code (7 bits a byte), which takes
+//      one or two bytes a state for a large layer.
+//
+//      A layer is expanded by streaming its file.  The successors are collected in a
+//      buffer of EXTERNAL_RUN_KEYS keys; a full buffer is sorted, its duplicates
+//      dropped, and written to a run file.  The runs are then merged into the next
+//      layer, leaving out keys that are in any earlier layer.  Since slides can't be
+//      undone, a state can come back from any earlier depth, not only the last two,
+//      so the keys of every earlier layer are kept merged in one more file, "seen",
+//      which is written again, with the new layer added, in the same pass.  The
+//      earlier layers together are a fraction of the newest, so this costs little.
+//      A layer with more than EXTERNAL_MERGE_FILES runs has them merged in passes of
+//      that many first.
+//
+//      Memory is two run buffers, and two blocks for each file open, however large
+//      the layers grow.  At most EXTERNAL_MERGE_FILES runs and the seen file are read
+//      at once, and two files written.  Disk work overlaps the search: a full run
+//      buffer is sorted and written by a background thread while the other one is
+//      filled, and each open file is read or written a block ahead by a thread of
+//      its own.  The files go in a new directory, made in the directory given, so
+//      searches sharing a directory can't overwrite each other's files.
+//
+//      The moves are recovered from the layer files: the predecessors of the goal
+//      state (see generatePredecessors()) are looked for in the layer before it, and
+//      so on back to the start.
+//
+const size_t EXTERNAL_RUN_KEYS = 1 << 22;        // keys in a run buffer (32 MB with 64-bit keys)
+const size_t EXTERNAL_BLOCK_BYTES = 1 << 18;     // bytes read or written at a time
+const size_t EXTERNAL_MERGE_FILES = 32;          // most runs merged at once
+
+struct ExternalSolverContext {
+    string directory;                  // where the search's files go, "." by default
+    string filePrefix;                 // start of the names of this search's files
+    ostream *progress;                 // a line per layer is written here, if not NULL
+    long statesExpanded;               // number of states expanded by the last solve
+    vector< uint64_t> layerStates;     // number of states in each layer
+    vector< uint64_t> layerBytes;      // size of each layer's file
+    bool collectStats;                 // fill in stats on each solve, see SolverStats
+    SolverStats stats;                 // statistics for the last solve, if collectStats is set
+
+    ExternalSolverContext() : directory( "."), progress( NULL), statesExpanded( 0), collectStats( false) { }
+};
+
+
+//-------------------------------------------------------------------------------------
+// BlockThread
+//      A long-lived thread that does one job over and over for a key file, such as
+//      writing its last full block.  start() hands the job to the thread and wait()
+//      waits until it is done.  The thread is started by the first start() and
+//      stopped by the destructor, so a file has one thread however many blocks it has.
+//
+class BlockThread {
+public:
+    explicit BlockThread( const function< void()> &job) : job( job), pending( false), quitting( false) {}
+    ~BlockThread();
+    void start();
+    void wait();
+
+private:
+    BlockThread( const BlockThread &);           // not copyable
+    BlockThread &operator=( const BlockThread &);
+    void run();
+
+    function< void()> job;
+    mutex lock;                        // guards the two below
+    condition_variable changed;
+    bool pending;                      // the job has been started and isn't done
+    bool quitting;
+    thread worker;
+};
+
+BlockThread::~BlockThread()
+{
+    if( worker.joinable()) {
+        {
+            lock_guard< mutex> hold( lock);
+            quitting = true;
+            changed.notify_all();
+        }
+        worker.join();
+    }
+}
+
+void BlockThread::start()
+{
+    if( !worker.joinable()) {
+        worker = thread( &BlockThread::run, this);
+    }
+    lock_guard< mutex> hold( lock);
+    pending = true;
+    changed.notify_all();
+}
+
+void BlockThread::wait()
+{
+    unique_lock< mutex> hold( lock);
+    changed.wait( hold, [this]() { return !pending; });
+}
+
+void BlockThread::run()
+{
+    unique_lock< mutex> hold( lock);
+    while( true) {
+        changed.wait( hold, [this]() { return pending || quitting; });
+        if( !pending) {
+            return;        // quitting, with no job left
+        }
+        hold.unlock();
+        job();
+        hold.lock();
+        pending = false;
+        changed.notify_all();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// KeyFileWriter
+//      Writes increasing keys to a file, as differences in the variable-length code.
+//      Full blocks are written by a background thread while the next one is filled.
+//
+class KeyFileWriter {
+public:
+    KeyFileWriter() : writer( [this]() { file.write( (const char *)&writing[ 0], writing.size()); }),
+                      previous( 0), count( 0), bytes( 0), failed( false) {}
+    ~KeyFileWriter() { close(); }
+    bool open( const string &fileName);
+    void add( StateKey key);           // key must be greater than the one before
+    bool close();                      // false if anything couldn't be written
+    uint64_t size() const { return count; }
+    uint64_t fileBytes() const { return bytes; }
+
+private:
+    KeyFileWriter( const KeyFileWriter &);       // not copyable
+    KeyFileWriter &operator=( const KeyFileWriter &);
+    void writeBlock();
+
+    ofstream file;
+    vector< unsigned char> block;      // being filled
+    vector< unsigned char> writing;    // being written by writer
+    BlockThread writer;
+    StateKey previous;
+    uint64_t count;
+    uint64_t bytes;
+    bool failed;
+};
+
+bool KeyFileWriter::open( const string &fileName)
+{
+    file.open( fileName.c_str(), ios::binary | ios::trunc);
+    block.reserve( EXTERNAL_BLOCK_BYTES + 16);
+    previous = 0;
+    count = bytes = 0;
+    failed = file.fail();
+    return !failed;
+}
+
+void KeyFileWriter::add( StateKey key)
+{
+    uint64_t difference = (uint64_t)(key - previous);
+    previous = key;
+    while( difference >= 0x80) {
+        block.push_back( (unsigned char)(difference | 0x80));
+        difference >>= 7;
+    }
+    block.push_back( (unsigned char)difference);
+    count++;
+    if( block.size() >= EXTERNAL_BLOCK_BYTES) {
+        writeBlock();
+    }
+}
+
+void KeyFileWriter::writeBlock()
+{
+    writer.wait();
+    bytes += block.size();
+    writing.swap( block);
+    block.clear();
+    writer.start();
+}
+
+bool KeyFileWriter::close()
+{
+    if( !file.is_open()) {
+        return !failed;
+    }
+    if( !block.empty()) {
+        writeBlock();
+    }
+    writer.wait();
+    file.close();
+    failed = failed || file.fail();
+    return !failed;
+}
+
+
+//-------------------------------------------------------------------------------------
+// KeyFileReader
+//      Reads back the keys written by a KeyFileWriter, in order.  The next block of
+//      the file is read by a background thread while this one is decoded.
+//
+class KeyFileReader {
+public:
+    KeyFileReader() : reader( [this]() {
+                          loading.resize( EXTERNAL_BLOCK_BYTES);
+                          file.read( (char *)&loading[ 0], loading.size());
+                          loading.resize( (size_t)file.gcount());
+                      }),
+                      reading( false), position( 0), previous( 0) {}
+    ~KeyFileReader() { close(); }
+    bool open( const string &fileName);
+    bool next( StateKey &key);         // false at the end of the file
+    void close();
+
+private:
+    KeyFileReader( const KeyFileReader &);       // not copyable
+    KeyFileReader &operator=( const KeyFileReader &);
+    void readAhead();
+    bool nextByte( unsigned char &byte);
+
+    ifstream file;
+    vector< unsigned char> block;      // being decoded
+    vector< unsigned char> loading;    // being read by reader
+    BlockThread reader;
+    bool reading;                      // reader has been started on loading
+    size_t position;                   // next byte of block to decode
+    StateKey previous;
+};
+
+bool KeyFileReader::open( const string &fileName)
+{
+    file.open( fileName.c_str(), ios::binary);
+    block.clear();
+    position = 0;
+    previous = 0;
+    if( file.fail()) {
+        return false;
+    }
+    readAhead();
+    return true;
+}
+
+void KeyFileReader::readAhead()
+{
+    reading = true;
+    reader.start();
+}
+
+inline bool KeyFileReader::nextByte( unsigned char &byte)
+{
+    if( position == block.size()) {
+        if( !reading) {
+            return false;
+        }
+        reader.wait();
+        reading = false;
+        block.swap( loading);
+        position = 0;
+        if( block.empty()) {
+            return false;      // end of the file
+        }
+        readAhead();
+    }
+    byte = block[ position++];
+    return true;
+}
+
+bool KeyFileReader::next( StateKey &key)
+{
+    uint64_t difference = 0;
+    unsigned char byte;
+    for( int shift=0; ; shift+=7) {
+        if( !nextByte( byte)) {
+            return false;
+        }
+        difference |= (uint64_t)(byte & 0x7F) << shift;
+        if( (byte & 0x80) == 0) {
+            break;
+        }
+    }
+    previous += (StateKey)difference;
+    key = previous;
+    return true;
+}
+
+void KeyFileReader::close()
+{
+    reader.wait();
+    reading = false;
+    if( file.is_open()) {
+        file.close();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// KeyMerger
+//      Merges several key files into one increasing sequence, each key given once.
+//
+class KeyMerger {
+public:
+    bool open( const vector< string> &fileNames);
+    bool next( StateKey &key);         // false when every file is used up
+
+private:
+    vector< unique_ptr< KeyFileReader>> readers;
+    priority_queue< pair< StateKey, size_t>, vector< pair< StateKey, size_t>>,
+                    greater< pair< StateKey, size_t>>> heads;     // next key of each file, smallest first
+};
+
+bool KeyMerger::open( const vector< string> &fileNames)
+{
+    for( size_t i=0; i<fileNames.size(); i++) {
+        readers.push_back( unique_ptr< KeyFileReader>( new KeyFileReader));
+        StateKey key;
+        if( !readers[ i]->open( fileNames[ i])) {
+            return false;
+        }
+        if( readers[ i]->next( key)) {
+            heads.push( make_pair( key, i));
+        }
+    }
+    return true;
+}
+
+bool KeyMerger::next( StateKey &key)
+{
+    if( heads.empty()) {
+        return false;
+    }
+    key = heads.top().first;
+    while( !heads.empty() && (heads.top().first == key)) {
+        size_t i = heads.top().second;
+        heads.pop();
+        StateKey following;
+        if( readers[ i]->next( following)) {
+            heads.push( make_pair( following, i));
+        }
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// makeExternalFileDirectory() and removeExternalFileDirectory()
+//      Make a new directory for one search's files in the context's directory, and
+//      set filePrefix to it.  Returns false if it can't be made.  Without mkdtemp()
+//      the files go in the directory given, named for the process and the search.
+//
+bool makeExternalFileDirectory( ExternalSolverContext &context)
+{
+#if !defined( _WIN32)
+    string pattern = context.directory + "/rr-XXXXXX";
+    vector< char> name( pattern.begin(), pattern.end());
+    name.push_back( 0);
+    if( mkdtemp( &name[ 0]) == NULL) {
+        return false;
+    }
+    context.filePrefix = string( &name[ 0]) + "/";
+#else
+    static atomic< int> searchNumber( 0);
+    context.filePrefix = context.directory + "/rr-" + to_string( _getpid()) + "-" + to_string( searchNumber++) + "-";
+#endif
+    return true;
+}
+
+void removeExternalFileDirectory( const ExternalSolverContext &context)
+{
+#if !defined( _WIN32)
+    rmdir( context.filePrefix.substr( 0, context.filePrefix.size() - 1).c_str());
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+// externalFileName() - Name of a layer, run or seen file of the search
+//
+string externalFileName( const ExternalSolverContext &context, const char *kind, size_t number)
+{
+    ostringstream name;
+    name << context.filePrefix << kind << "-" << number << ".keys";
+    return name.str();
+}
+
+
+//-------------------------------------------------------------------------------------
+// solvePuzzleExternal()
+//      Version of solvePuzzle() that keeps its layers on disk, with the same parameters
+//      and results.  Returns false, with an error on cout, if the files can't be
+//      written.  The files are removed before it returns.
+//
+bool solvePuzzleExternal( ExternalSolverContext &context,                // directory and results
+                          const Board &board,                            // compiled board to solve on
+                          const int startRobots[ NUMBER_OF_ROBOTS + 1],  // robot positions, theRobots layout
+                          int goalRobot,                                 // robot that needs to reach destination
+                          int goalPosition,                              // square it has to stop on
+                          int maxMoves,                                  // longest solution to look for
+                          vector<SolverMove> &solution)                  // returns the moves found
+{
+    context.statesExpanded = 0;
+    context.layerStates.clear();
+    context.layerBytes.clear();
+    solution.clear();
+    bool collectStats = SOLVER_STATS_ENABLED && context.collectStats;
+    chrono::steady_clock::time_point solveStart = chrono::steady_clock::now();
+    if( collectStats) {
+        resetSolverStats( context.stats, "external");
+    }
+    if( startRobots[ goalRobot] == goalPosition) {
+        return true;       // nothing to do
+    }
+
+    if( !makeExternalFileDirectory( context)) {
+        cout << "*** Error, could not make a directory for the search files in " << context.directory << endl;
+        return false;
+    }
+    StateKey startKey = canonicalKey( packRobots( startRobots), goalRobot);
+    vector< string> layerNames( 1, externalFileName( context, "layer", 0));
+    string seenName = externalFileName( context, "seen", 0);       // every state of the layers so far
+    KeyFileWriter startWriter, startSeen;
+    bool writeFailed = !startWriter.open( layerNames[ 0]) || !startSeen.open( seenName);
+    startWriter.add( startKey);
+    startSeen.add( startKey);
+    writeFailed = !startWriter.close() || !startSeen.close() || writeFailed;
+    context.layerStates.push_back( 1);
+    context.layerBytes.push_back( startWriter.fileBytes());
+    uint64_t seenBytes = startSeen.fileBytes();
+
+    StateKey goalKey = 0;
+    int goalDepth = 0;
+    for( int depth=0; (depth < maxMoves) && (goalDepth == 0) && !writeFailed; depth++) {
+        if( collectStats) {
+            depthStats( context.stats, depth).startMicroseconds = microsecondsSince( solveStart);
+        }
+        long expandedBefore = context.statesExpanded;
+        long generated = 0;
+        long newStates = -1;               // states of the next layer, once it is merged
+        uint64_t runBytes = 0;             // size of the run files written
+        uint64_t nextSeenBytes = 0;
+
+        // Expand the layer into sorted runs.  A full buffer is handed to the spill
+        // thread, which sorts and writes it while the other buffer is filled.
+        vector< string> runNames;
+        size_t runCount = 0;               // run files made for this layer, for their names
+        vector< StateKey> buffer, spilling;
+        buffer.reserve( EXTERNAL_RUN_KEYS);
+        thread spiller;
+        bool spillFailed = false;
+        auto spill = [&]() {
+            if( spiller.joinable()) {
+                spiller.join();
+            }
+            spilling.swap( buffer);
+            buffer.clear();
+            runNames.push_back( externalFileName( context, "run", runCount++));
+            string runName = runNames.back();
+            spiller = thread( [&spilling, &spillFailed, &runBytes, runName]() {
+                sort( spilling.begin(), spilling.end());
+                KeyFileWriter run;
+                bool opened = run.open( runName);
+                for( size_t i=0; i<spilling.size(); i++) {
+                    if( (i == 0) || (spilling[ i] != spilling[ i-1])) {
+                        run.add( spilling[ i]);
+                    }
+                }
+                spillFailed = !run.close() || !opened || spillFailed;
+                runBytes += run.fileBytes();
+            });
+        };
+
+        KeyFileReader layer;
+        writeFailed = !layer.open( layerNames[ depth]);
+        StateKey key;
+        while( (goalDepth == 0) && layer.next( key)) {
+            context.statesExpanded++;
+            // the successors go straight into the run buffer
+            size_t first = buffer.size();
+            unsigned char successorMoves[ MAX_SUCCESSORS];
+            buffer.resize( first + MAX_SUCCESSORS);
+            buffer.resize( first + generateSuccessors( board, key, &buffer[ first], successorMoves));
+            generated += (long)(buffer.size() - first);
+            for( size_t i=first; i<buffer.size(); i++) {
+                buffer[ i] = canonicalKey( buffer[ i], goalRobot);
+                if( robotPosition( buffer[ i], goalRobot) == goalPosition) {
+                    goalKey = buffer[ i];      // can't be in an earlier layer, or the search would have stopped
+                    goalDepth = depth + 1;
+                    break;
+                }
+            }
+            if( buffer.size() + MAX_SUCCESSORS > EXTERNAL_RUN_KEYS) {
+                spill();
+            }
+        }
+        layer.close();
+        if( (goalDepth == 0) && !buffer.empty()) {
+            spill();
+        }
+        if( spiller.joinable()) {
+            spiller.join();
+        }
+        writeFailed = writeFailed || spillFailed;
+
+        // merge the runs in passes, until there are few enough to merge at once
+        while( (goalDepth == 0) && !writeFailed && (runNames.size() > EXTERNAL_MERGE_FILES)) {
+            vector< string> mergedNames;
+            for( size_t first=0; first<runNames.size(); first+=EXTERNAL_MERGE_FILES) {
+                vector< string> group( runNames.begin() + first,
+                                       runNames.begin() + min( first + EXTERNAL_MERGE_FILES, runNames.size()));
+                mergedNames.push_back( externalFileName( context, "run", runCount++));
+                {
+                    KeyMerger runs;
+                    KeyFileWriter merged;
+                    writeFailed = !runs.open( group) || !merged.open( mergedNames.back()) || writeFailed;
+                    while( runs.next( key)) {
+                        merged.add( key);
+                    }
+                    writeFailed = !merged.close() || writeFailed;
+                }
+                for( size_t i=0; i<group.size(); i++) {
+                    remove( group[ i].c_str());
+                }
+            }
+            runNames.swap( mergedNames);
+        }
+
+        // merge the runs into the next layer, leaving out states of earlier layers,
+        // and add the new states to the seen file
+        if( (goalDepth == 0) && !writeFailed) {
+            KeyMerger runs;
+            KeyFileReader earlier;
+            writeFailed = !runs.open( runNames) || !earlier.open( seenName);
+            layerNames.push_back( externalFileName( context, "layer", depth + 1));
+            string nextSeenName = externalFileName( context, "seen", depth + 1);
+            KeyFileWriter next, nextSeen;
+            writeFailed = !next.open( layerNames.back()) || !nextSeen.open( nextSeenName) || writeFailed;
+            StateKey earlierKey = 0;
+            bool moreEarlier = earlier.next( earlierKey);
+            while( runs.next( key)) {
+                while( moreEarlier && (earlierKey < key)) {
+                    nextSeen.add( earlierKey);
+                    moreEarlier = earlier.next( earlierKey);
+                }
+                if( !moreEarlier || (earlierKey != key)) {
+                    next.add( key);
+                    nextSeen.add( key);
+                }
+            }
+            while( moreEarlier) {
+                nextSeen.add( earlierKey);
+                moreEarlier = earlier.next( earlierKey);
+            }
+            earlier.close();
+            writeFailed = !next.close() || !nextSeen.close() || writeFailed;
+            remove( seenName.c_str());
+            seenName = nextSeenName;
+            context.layerStates.push_back( next.size());
+            context.layerBytes.push_back( next.fileBytes());
+            newStates = (long)next.size();
+            nextSeenBytes = nextSeen.fileBytes();
+            if( context.progress != NULL) {
+                *context.progress << "Depth " << (depth + 1) << ": " << next.size() << " new states, "
+                                  << next.fileBytes() / 1024 << " KB on disk" << endl;
+            }
+        }
+        for( size_t i=0; i<runNames.size(); i++) {
+            remove( runNames[ i].c_str());
+        }
+        if( collectStats) {
+            // the disk held every layer, both seen files and the level's runs at once
+            SolverStats &stats = context.stats;
+            uint64_t onDisk = seenBytes + nextSeenBytes + runBytes;
+            for( size_t i=0; i<context.layerBytes.size(); i++) {
+                onDisk += context.layerBytes[ i];
+            }
+            stats.diskBytes = max( stats.diskBytes, onDisk);
+            size_t filesOpen = min( runNames.size(), EXTERNAL_MERGE_FILES) + 3;      // runs, seen, and the two written
+            stats.peakBytes = max( stats.peakBytes, (buffer.capacity() + spilling.capacity()) * sizeof( StateKey) +
+                                                    filesOpen * 2 * EXTERNAL_BLOCK_BYTES);
+            DepthStats &level = stats.depths[ depth];
+            level.expanded = context.statesExpanded - expandedBefore;
+            level.generated = generated;
+            level.duplicates = (newStates >= 0) ? generated - newStates : 0;
+            level.microseconds = microsecondsSince( solveStart) - level.startMicroseconds;
+        }
+        if( newStates >= 0) {
+            seenBytes = nextSeenBytes;
+        }
+        if( (goalDepth == 0) && (context.layerStates.back() == 0)) {
+            break;     // every reachable state has been seen
+        }
+    }
+
+    // Walk back from the goal, finding a predecessor of each state in the layer
+    // before.  Both are in increasing order, so that is a merge.
+    vector< pair< StateKey, int>> moves;
+    for( int depth=goalDepth - 1; (depth >= 0) && !writeFailed; depth--) {
+        StateKey predecessorKeys[ MAX_PREDECESSORS];
+        unsigned char moveCodes[ MAX_PREDECESSORS];
+        int count = generatePredecessors( board, goalKey, goalRobot, predecessorKeys, moveCodes);
+        vector< pair< StateKey, int>> predecessors;
+        for( int i=0; i<count; i++) {
+            predecessors.push_back( make_pair( predecessorKeys[ i], (int)moveCodes[ i]));
+        }
+        sort( predecessors.begin(), predecessors.end());
+        KeyFileReader layer;
+        writeFailed = !layer.open( layerNames[ depth]);
+        StateKey key;
+        size_t candidate = 0;
+        while( (candidate < predecessors.size()) && layer.next( key)) {
+            while( (candidate < predecessors.size()) && (predecessors[ candidate].first < key)) {
+                candidate++;
+            }
+            if( (candidate < predecessors.size()) && (predecessors[ candidate].first == key)) {
+                moves.push_back( predecessors[ candidate]);
+                goalKey = key;
+                break;
+            }
+        }
+        if( moves.size() != (size_t)(goalDepth - depth)) {
+            writeFailed = true;    // the layer files have been damaged
+        }
+    }
+    for( size_t i=0; i<layerNames.size(); i++) {
+        remove( layerNames[ i].c_str());
+    }
+    remove( seenName.c_str());
+    removeExternalFileDirectory( context);
+    if( collectStats) {
+        addUpDepthStats( context.stats);
+        context.stats.microseconds = microsecondsSince( solveStart);
+    }
+    if( writeFailed) {
+        cout << "*** Error, could not write or read back the search files in " << context.directory << endl;
+        return false;
+    }
+    if( goalDepth == 0) {
+        return false;
+    }
+    reverse( moves.begin(), moves.end());
+    canonicalMovesToSolution( board, startRobots, moves, solution);
+    return true;
+}//end solvePuzzleExternal()
+
+
+//-------------------------------------------------------------------------------------
+// Solution cache
+//      Remembers the solutions found for positions, so a position asked for again is
+//      answered without a search.  An entry is keyed by a hash of the compiled board
+//      (walls and letters), the packed robot positions, the goal robot and the goal
+//      square.  Editing board.txt changes the hash, so entries for the old board are
+//      never returned, and are replaced as new entries need their slots.
+//
+//      There are two tiers.  The most recently used entries are kept in memory, in a
+//      hash map with a list for LRU order.  Every entry is also written to a cache
+//      file, a fixed-size table of slots that is memory mapped on POSIX systems (read
+//      at open and written back at close elsewhere), so the cache survives restarts:
+//
+//          SolutionCacheHeader  magic "RRSC", version, entry size, number of slots,
+//                               board edge and number of robots
+//          SolutionCacheEntry   slotCount entries, 64 bytes each
+//
+//      An entry hashes to a bucket of SOLUTION_CACHE_WAYS slots; a new entry takes an
+//      empty slot of its bucket, or replaces one.  Each entry carries a checksum of
+//      its contents, so one left half-written by a crash is treated as empty.
+//      Both tiers are shared by the batch workers, under one mutex.
+//
+const uint32_t SOLUTION_CACHE_MAGIC = 0x43535252;     // "RRSC" in a little-endian file
+const uint32_t SOLUTION_CACHE_VERSION = 1;
+const uint32_t SOLUTION_CACHE_SLOTS = 1 << 16;         // slots in a new cache file (4 MB).  A power of 2.
+const int SOLUTION_CACHE_WAYS = 4;                     // slots in a bucket
+const size_t SOLUTION_CACHE_MEMORY_ENTRIES = 1 << 14;  // entries kept in the memory tier
+const int SOLUTION_CACHE_MAX_MOVES = 40;               // longest solution that can be stored
+const unsigned char NO_CACHED_SOLUTION = 255;          // moveCount of a position with no solution
+
+// Aligned so each entry after it fills one 64-byte cache line
+struct alignas( 64) SolutionCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entrySize;        // sizeof( SolutionCacheEntry)
+    uint32_t slotCount;
+    uint32_t boardEdge;        // BOARD_EDGE of the program that wrote it
+    uint32_t numberOfRobots;   // NUMBER_OF_ROBOTS of the program that wrote it
+};
+
+struct SolutionCacheEntry {
+    uint64_t boardHash;        // boardHash() of the board
+    uint64_t robots;           // packRobots() of the starting position
+    unsigned char goalRobot;
+    unsigned char goalPosition;
+    unsigned char moveCount;   // solution length, or NO_CACHED_SOLUTION if there is none
+    unsigned char searchedMoves;   // with no solution: the longest solution that was looked for
+    uint32_t check;            // checksum of the rest of the entry, 0 for an empty slot
+    unsigned char moves[ SOLUTION_CACHE_MAX_MOVES];    // (robot-1)*4 + direction
+};
+
+
+//-------------------------------------------------------------------------------------
+// solutionCacheHash() and solutionCacheCheck()
+//      Hash of an entry's key, which picks its bucket and its memory tier slot, and
+//      the checksum of a whole entry.
+//
+inline uint64_t solutionCacheHash( const SolutionCacheEntry &entry)
+{
+    uint64_t hash = entry.boardHash ^ (entry.robots * 0x9E3779B97F4A7C15ULL);
+    hash ^= ((uint64_t)entry.goalRobot << 8 | entry.goalPosition) * 0xC2B2AE3D27D4EB4FULL;
+    return hash ^ (hash >> 29);
+}
+
+inline uint32_t solutionCacheCheck( const SolutionCacheEntry &entry)
+{
+    SolutionCacheEntry copy = entry;
+    copy.check = 0;
+    uint64_t hash = hashBytes( 0xCBF29CE484222325ULL, &copy, sizeof( copy));
+    return (uint32_t)(hash ^ (hash >> 32)) | 1;      // never 0, which marks an empty slot
+}
+
+inline bool sameSolutionCacheKey( const SolutionCacheEntry &a, const SolutionCacheEntry &b)
+{
+    return (a.boardHash == b.boardHash) && (a.robots == b.robots) &&
+           (a.goalRobot == b.goalRobot) && (a.goalPosition == b.goalPosition);
+}
+
+
+//-------------------------------------------------------------------------------------
+// SolutionCache
+//      lookup() fills in solved and solution and returns true if the cache can answer
+//      for a search of up to maxMoves moves.  store() records the result of a search.
+//      Without a successful open() only the memory tier is used.
+//
+class SolutionCache {
+public:
+    SolutionCache() : header( NULL), slots( NULL), mappedSize( 0) {}
+    ~SolutionCache();
+    bool open( const char *fileName);        // false if the file can't be opened or created
+    void close();
+    bool lookup( const Board &board, const int robots[ NUMBER_OF_ROBOTS + 1], int goalRobot,
+                 int goalPosition, int maxMoves, bool &solved, vector< SolverMove> &solution);
+    void store( const Board &board, const int robots[ NUMBER_OF_ROBOTS + 1], int goalRobot,
+                int goalPosition, int maxMoves, bool solved, const vector< SolverMove> &solution);
+
+private:
+    SolutionCache( const SolutionCache &);   // not copyable
+    SolutionCache &operator=( const SolutionCache &);
+
+    void remember( const SolutionCacheEntry &entry);     // put an entry at the front of the memory tier
+
+    mutex lock;                              // guards everything below
+    list< SolutionCacheEntry> recent;        // memory tier, most recently used first
+    unordered_map< uint64_t, list< SolutionCacheEntry>::iterator> recentByHash;
+    SolutionCacheHeader *header;             // cache file, NULL if there is none
+    SolutionCacheEntry *slots;
+    size_t mappedSize;                       // 0 if the file was read instead of mapped
+    string fileName;                         // written back at close, if it was read
+    vector< char> readImage;
+};
+
+SolutionCache::~SolutionCache()
+{
+    close();
+}
+
+void SolutionCache::close()
+{
+#if !defined( _WIN32)
+    if( mappedSize > 0) {
+        munmap( (void *)header, mappedSize);
+    }
+#else
+    if( header != NULL) {
+        ofstream outStream( fileName.c_str(), ios::binary | ios::trunc);
+        outStream.write( &readImage[ 0], readImage.size());
+    }
+#endif
+    header = NULL;
+    slots = NULL;
+    mappedSize = 0;
+    readImage.clear();
+}
+
+bool SolutionCache::open( const char *name)
+{
+    close();
+    fileName = name;
+    size_t fileSize = sizeof( SolutionCacheHeader) + (size_t)SOLUTION_CACHE_SLOTS * sizeof( SolutionCacheEntry);
+
+    // a new file, or one from a different layout or configuration, starts out empty
+    SolutionCacheHeader expected;
+    memset( &expected, 0, sizeof( expected));
+    expected.magic = SOLUTION_CACHE_MAGIC;
+    expected.version = SOLUTION_CACHE_VERSION;
+    expected.entrySize = sizeof( SolutionCacheEntry);
+    expected.slotCount = SOLUTION_CACHE_SLOTS;
+    expected.boardEdge = BOARD_EDGE;
+    expected.numberOfRobots = NUMBER_OF_ROBOTS;
+    SolutionCacheHeader found;
+    memset( &found, 0, sizeof( found));
+    struct stat fileStatus;
+    if( (stat( name, &fileStatus) == 0) && ((size_t)fileStatus.st_size == fileSize)) {
+        ifstream inStream( name, ios::binary);
+        inStream.read( (char *)&found, sizeof( found));
+    }
+    bool fresh = (memcmp( &found, &expected, sizeof( expected)) != 0);
+
+#if !defined( _WIN32)
+    int file = ::open( name, O_RDWR | O_CREAT | (fresh ? O_TRUNC : 0), 0644);
+    if( file < 0) {
+        return false;
+    }
+    if( fresh && (ftruncate( file, (off_t)fileSize) != 0)) {    // a new file reads as zeros: all slots empty
+        ::close( file);
+        return false;
+    }
+    void *mapping = mmap( NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close( file);             // the mapping stays valid
+    if( mapping == MAP_FAILED) {
+        return false;
+    }
+    header = (SolutionCacheHeader *)mapping;
+    mappedSize = fileSize;
+#else
+    readImage.assign( fileSize, 0);
+    if( !fresh) {
+        ifstream inStream( name, ios::binary);
+        inStream.read( &readImage[ 0], fileSize);
+    }
+    header = (SolutionCacheHeader *)&readImage[ 0];
+#endif
+    slots = (SolutionCacheEntry *)(header + 1);
+    if( fresh) {
+        *header = expected;
+    }
+    return true;
+}//end SolutionCache::open()
+
+void SolutionCache::remember( const SolutionCacheEntry &entry)
+{
+    uint64_t hash = solutionCacheHash( entry);
+    unordered_map< uint64_t, list< SolutionCacheEntry>::iterator>::iterator found = recentByHash.find( hash);
+    if( found != recentByHash.end()) {
+        recent.erase( found->second);
+    }
+    else if( recent.size() >= SOLUTION_CACHE_MEMORY_ENTRIES) {
+        recentByHash.erase( solutionCacheHash( recent.back()));     // drop the least recently used
+        recent.pop_back();
+    }
+    recent.push_front( entry);
+    recentByHash[ hash] = recent.begin();
+}
+
+bool SolutionCache::lookup( const Board &board, const int robots[ NUMBER_OF_ROBOTS + 1], int goalRobot,
+                            int goalPosition, int maxMoves, bool &solved, vector< SolverMove> &solution)
+{
+    SolutionCacheEntry key;
+    key.boardHash = boardHash( board);
+    key.robots = packRobots( robots);
+    key.goalRobot = (unsigned char)goalRobot;
+    key.goalPosition = (unsigned char)goalPosition;
+    uint64_t hash = solutionCacheHash( key);
+
+    lock_guard< mutex> guard( lock);
+    const SolutionCacheEntry *entry = NULL;
+    unordered_map< uint64_t, list< SolutionCacheEntry>::iterator>::iterator found = recentByHash.find( hash);
+    if( (found != recentByHash.end()) && sameSolutionCacheKey( *found->second, key)) {
+        recent.splice( recent.begin(), recent, found->second);    // now the most recently used
+        entry = &recent.front();
+    }
+    else if( slots != NULL) {
+        SolutionCacheEntry *bucket = slots + (hash & (header->slotCount - SOLUTION_CACHE_WAYS));
+        for( int way=0; (way < SOLUTION_CACHE_WAYS) && (entry == NULL); way++) {
+            if( (bucket[ way].check != 0) && sameSolutionCacheKey( bucket[ way], key) &&
+                (bucket[ way].check == solutionCacheCheck( bucket[ way]))) {
+                remember( bucket[ way]);
+                entry = &recent.front();
+            }
+        }
+    }
+    if( entry == NULL) {
+        return false;
+    }
+
+    // An optimal solution longer than maxMoves means there is none that short.  A
+    // position with no solution only answers for searches no deeper than the one stored.
+    solution.clear();
+    if( entry->moveCount == NO_CACHED_SOLUTION) {
+        solved = false;
+        return maxMoves <= entry->searchedMoves;
+    }
+    solved = (entry->moveCount <= maxMoves);
+    for( int i=0; solved && (i < entry->moveCount); i++) {
+        solution.push_back( solverMoveFromCode( entry->moves[ i]));
+    }
+    return true;
+}//end SolutionCache::lookup()
+
+void SolutionCache::store( const Board &board, const int robots[ NUMBER_OF_ROBOTS + 1], int goalRobot,
+                           int goalPosition, int maxMoves, bool solved, const vector< SolverMove> &solution)
+{
+    if( solved && (solution.size() > (size_t)SOLUTION_CACHE_MAX_MOVES)) {
+        return;        // too long to store
+    }
+    SolutionCacheEntry entry;
+    memset( &entry, 0, sizeof( entry));         // no stray bytes in the file or checksum
+    entry.boardHash = boardHash( board);
+    entry.robots = packRobots( robots);
+    entry.goalRobot = (unsigned char)goalRobot;
+    entry.goalPosition = (unsigned char)goalPosition;
+    entry.moveCount = solved ? (unsigned char)solution.size() : NO_CACHED_SOLUTION;
+    entry.searchedMoves = (unsigned char)min( maxMoves, (int)NO_CACHED_SOLUTION);
+    for( size_t i=0; i<solution.size(); i++) {
+        int direction = (int)(find( DIRECTION_LETTERS, DIRECTION_LETTERS + NUMBER_OF_DIRECTIONS,
+                                    solution[ i].direction) - DIRECTION_LETTERS);
+        entry.moves[ i] = (unsigned char)((solution[ i].robot - 1) * NUMBER_OF_DIRECTIONS + direction);
+    }
+    entry.check = solutionCacheCheck( entry);
+
+    lock_guard< mutex> guard( lock);
+    remember( entry);
+    if( slots != NULL) {
+        // the slot already holding this key, else an empty one, else the one the hash picks
+        uint64_t hash = solutionCacheHash( entry);
+        SolutionCacheEntry *bucket = slots + (hash & (header->slotCount - SOLUTION_CACHE_WAYS));
+        int target = -1;
+        for( int way=0; way<SOLUTION_CACHE_WAYS; way++) {
+            if( (bucket[ way].check != 0) && sameSolutionCacheKey( bucket[ way], entry)) {
+                target = way;
+                break;
+            }
+            if( (bucket[ way].check == 0) && (target < 0)) {
+                target = way;
+            }
+        }
+        if( target < 0) {
+            target = (int)(hash >> 60) % SOLUTION_CACHE_WAYS;
+        }
+        bucket[ target] = entry;         // if this is cut short, the checksum won't match
+    }
+}//end SolutionCache::store()
+
+
+//-------------------------------------------------------------------------------------
+// Batch mode
+//      RicoRobots -batch [file] [-ida] [-cache cachefile]
+//      Reads puzzles from the file, or from standard input if no file is given, and
+//      writes one JSON line per puzzle to standard output, in input order.  The input
+//      is a series of lines:
+//
+//          board                        followed by a board definition, as in board.txt
+//          pack <file> <index>          board number index (from 0) of a board pack
+//          robots <r1> <r2> <r3> <r4>   starting squares for the goals that follow
+//          goal <robot> <letter>        solve one puzzle on the latest board and robots
+//
+//      A board or pack line also sets the robots to those in its definition.  Packs stay
+//      open for the rest of the run, and their boards are used where they are mapped,
+//      so switching between thousands of boards costs no parsing.  Blank lines and
+//      lines starting with # are skipped.  Each output line looks like
+//
+//          {"puzzle":1,"robot":2,"letter":"M","moves":7,"solution":["1L","2L",...],
+//           "expanded":7251,"microseconds":812}
+//
+//      with moves -1 if there is no solution of DEFAULT_MAX_SOLUTION_MOVES or less.
+//      A goal that can't be set up gets an "error" entry instead.  Puzzles are read
+//      BATCH_SIZE at a time and solved across a WorkerPool, each worker with its own
+//      SolverContext, so memory is reused from puzzle to puzzle.  With -cache, puzzles
+//      are looked up in a SolutionCache first, and answered ones get "expanded":0 and
+//      "cached":true.
+//
+const size_t BATCH_SIZE = 4096;
+
+struct BatchPuzzle {
+    shared_ptr< const Board> board;        // compiled board to solve on
+    int robots[ NUMBER_OF_ROBOTS + 1];     // starting squares, theRobots layout
+    int goalRobot;                         // robot that needs to reach destination
+    char destinationLetter;                // the destination letter
+    string error;                          // why the puzzle can't be solved, if it can't
+};
+
+
+//-------------------------------------------------------------------------------------
+// solveWithCache()
+//      Solve a puzzle, looking it up in the cache first if there is one, and storing
+//      what the search finds in it.  Sets cached if the answer came from the cache,
+//      with context.statesExpanded set to 0.  Returns true if it was solved.
+//
+bool solveWithCache( SolverContext &context,                        // reusable scratch memory
+                     const Board &board,                            // board walls and letters
+                     const int robots[ NUMBER_OF_ROBOTS + 1],       // starting squares, theRobots layout
+                     int goalRobot,                                 // robot that needs to reach goalPosition
+                     int goalPosition,                              // square of the destination letter
+                     bool useIda,                                   // solve with IDA* instead of breadth-first
+                     SolutionCache *cache,                          // solutions found before, NULL for none
+                     vector<SolverMove> &solution,                  // filled in with the moves
+                     bool &cached)                                  // set if answered from the cache
+{
+    bool solved = false;
+    cached = (cache != NULL) && cache->lookup( board, robots, goalRobot, goalPosition,
+                                               DEFAULT_MAX_SOLUTION_MOVES, solved, solution);
+    if( cached) {
+        context.statesExpanded = 0;        // answered without a search
+        return solved;
+    }
+    if( useIda) {
+        solved = solvePuzzleIDA( context, board, robots, goalRobot, goalPosition, DEFAULT_MAX_SOLUTION_MOVES, solution);
+    }
+    else {
+        solved = solvePuzzle( context, board, robots, goalRobot, goalPosition, DEFAULT_MAX_SOLUTION_MOVES, solution);
+    }
+    if( cache != NULL) {
+        cache->store( board, robots, goalRobot, goalPosition, DEFAULT_MAX_SOLUTION_MOVES, solved, solution);
+    }
+    return solved;
+}//end solveWithCache()
+
+
+// Write "moves":n,"solution":["1L",...] with moves -1 if there is no solution
+void writeSolutionJson( ostream &line, bool solved, const vector<SolverMove> &solution)
+{
+    line << "\"moves\":" << (solved ? (int)solution.size() : -1) << ",\"solution\":[";
+    for( size_t i=0; i<solution.size(); i++) {
+        line << (i > 0 ? "," : "") << "\"" << solution[ i].robot << solution[ i].direction << "\"";
+    }
+    line << "]";
+}
+
+
+//-------------------------------------------------------------------------------------
+// solveBatchPuzzle() - Solve one batch puzzle and return its JSON output line
+//
+string solveBatchPuzzle( SolverContext &context,        // this worker's scratch memory
+                         const BatchPuzzle &puzzle,     // puzzle to solve
+                         long puzzleNumber,             // counts from 1 in the input
+                         bool useIda,                   // solve with IDA* instead of breadth-first
+                         SolutionCache *cache)          // solutions found before, NULL for none
+{
+    ostringstream line;
+    line << "{\"puzzle\":" << puzzleNumber << ",\"robot\":" << puzzle.goalRobot
+         << ",\"letter\":\"" << puzzle.destinationLetter << "\"";
+    if( !puzzle.error.empty()) {
+        line << ",\"error\":\"" << puzzle.error << "\"}";
+        return line.str();
+    }
+
+    vector<SolverMove> solution;
+    int goalPosition = puzzle.board->targets[ puzzle.destinationLetter - 'A'];
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool cached;
+    bool solved = solveWithCache( context, *puzzle.board, puzzle.robots, puzzle.goalRobot, goalPosition,
+                                  useIda, cache, solution, cached);
+    long microseconds = (long)chrono::duration_cast< chrono::microseconds>(
+                                  chrono::steady_clock::now() - start).count();
+
+    line << ",";
+    writeSolutionJson( line, solved, solution);
+    line << ",\"expanded\":" << context.statesExpanded << ",\"microseconds\":" << microseconds
+         << (cached ? ",\"cached\":true}" : "}");
+    return line.str();
+}//end solveBatchPuzzle()
+
+
+//-------------------------------------------------------------------------------------
+// solveBatch()
+//      Solve the puzzles read so far across the pool, write their lines in order,
+//      and empty the list.
+//
+void solveBatch( WorkerPool &pool,                      // threads to solve with
+                 vector< SolverContext> &contexts,      // one per worker
+                 vector< BatchPuzzle> &puzzles,         // puzzles to solve
+                 long firstPuzzleNumber,                // number of puzzles[ 0]
+                 bool useIda,                           // solve with IDA* instead of breadth-first
+                 SolutionCache *cache)                  // solutions found before, NULL for none
+{
+    vector< string> results( puzzles.size());
+    atomic< size_t> nextPuzzle( 0);
+    pool.run( [&]( int worker) {
+        size_t begin, end;
+        while( takeChunk( nextPuzzle, puzzles.size(), 1, begin, end)) {
+            results[ begin] = solveBatchPuzzle( contexts[ worker], puzzles[ begin],
+                                                firstPuzzleNumber + (long)begin, useIda, cache);
+        }
+    });
+    for( size_t i=0; i<results.size(); i++) {
+        cout << results[ i] << '\n';
+    }
+    cout.flush();
+    puzzles.clear();
+}
+
+
+//-------------------------------------------------------------------------------------
+// runBatch() - Read and solve every puzzle in the input.  Returns the exit status.
+//
+int runBatch( istream &input, bool useIda, SolutionCache *cache)
+{
+    WorkerPool pool;
+    vector< SolverContext> contexts( pool.size());
+    vector< BatchPuzzle> puzzles;
+    long puzzlesRead = 0;
+
+    shared_ptr< const Board> board;          // latest board read
+    map< string, shared_ptr< BoardPack> > packs;     // board packs opened so far, by file name
+    int robots[ NUMBER_OF_ROBOTS + 1];       // latest robot positions
+    bool robotsValid = false;                // false after an invalid robots line
+    string line;
+    while( getline( input, line)) {
+        istringstream words( line);
+        string command;
+        if( !(words >> command) || (command[ 0] == '#')) {
+            continue;      // blank line or comment
+        }
+
+        if( command == "board") {
+            shared_ptr< Board> newBoard( new Board);
+            int numberOfDestinationPieces;
+            if( !readBoard( input, *newBoard, robots, numberOfDestinationPieces)) {
+                cerr << "*** Error, invalid board definition after puzzle " << puzzlesRead << ".  Exiting..." << endl;
+                solveBatch( pool, contexts, puzzles, puzzlesRead - (long)puzzles.size() + 1, useIda, cache);
+                return -1;
+            }
+            compileBoard( *newBoard);
+            board = newBoard;
+            robotsValid = true;
+        }
+        else if( command == "pack") {
+            string fileName;
+            long index = -1;
+            words >> fileName >> index;
+            shared_ptr< BoardPack> &pack = packs[ fileName];
+            if( !pack) {
+                pack.reset( new BoardPack);
+                if( !pack->open( fileName.c_str())) {
+                    pack.reset();
+                }
+            }
+            const BoardRecord *record = (pack && (index >= 0)) ? pack->record( (uint32_t)index) : NULL;
+            if( record == NULL) {
+                cerr << "*** Error, invalid board pack or index after puzzle " << puzzlesRead << ".  Exiting..." << endl;
+                solveBatch( pool, contexts, puzzles, puzzlesRead - (long)puzzles.size() + 1, useIda, cache);
+                return -1;
+            }
+            // share ownership of the pack, so the board stays mapped while puzzles use it
+            board = shared_ptr< const Board>( pack, &record->board);
+            for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+                robots[ i] = record->robots[ i];
+            }
+            robotsValid = true;
+        }
+        else if( command == "robots") {
+            robotsValid = true;
+            for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+                robotsValid = robotsValid && (words >> robots[ i]) && (robots[ i] >= 0) && (robots[ i] < BOARD_SIZE);
+                for( int j=1; robotsValid && (j<i); j++) {
+                    robotsValid = (robots[ j] != robots[ i]);
+                }
+            }
+            if( !robotsValid) {
+                cerr << "*** Error, invalid robots line: " << line << endl;
+            }
+        }
+        else if( command == "goal") {
+            BatchPuzzle puzzle;
+            string letter;
+            puzzle.board = board;
+            puzzle.goalRobot = 0;
+            puzzle.destinationLetter = '?';
+            words >> puzzle.goalRobot >> letter;
+            if( !letter.empty()) {
+                puzzle.destinationLetter = toupper( letter[ 0]);
+            }
+            if( !board) {
+                puzzle.error = "no board before this goal";
+            }
+            else if( !robotsValid) {
+                puzzle.error = "no valid robots line before this goal";
+            }
+            else if( (puzzle.goalRobot < 1) || (puzzle.goalRobot > NUMBER_OF_ROBOTS)) {
+                puzzle.error = "invalid robot";
+            }
+            else if( !isalpha( puzzle.destinationLetter) ||
+                     (board->targets[ puzzle.destinationLetter - 'A'] < 0)) {
+                puzzle.error = "letter is not on the board";
+            }
+            for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+                puzzle.robots[ i] = robots[ i];
+            }
+            puzzles.push_back( puzzle);
+            puzzlesRead++;
+            if( puzzles.size() == BATCH_SIZE) {
+                solveBatch( pool, contexts, puzzles, puzzlesRead - (long)BATCH_SIZE + 1, useIda, cache);
+            }
+        }
+        else {
+            cerr << "*** Error, unknown batch command: " << line << endl;
+        }
+    }//end while( getline...
+
+    solveBatch( pool, contexts, puzzles, puzzlesRead - (long)puzzles.size() + 1, useIda, cache);
+    return 0;
+}//end runBatch()
+
+
+//-------------------------------------------------------------------------------------
+// Server mode
+//      RicoRobots -serve [port | socket path] [-ida] [-cache cachefile]
+//      Answers requests from other programs without starting a process or reading a
+//      board for each one.  Listens on a localhost TCP port (DEFAULT_SERVER_PORT if
+//      none is given), or on a Unix domain socket if given a path.  A connection sends
+//      requests one per line, and gets one JSON line back for each, in order, so a
+//      client can send many requests without waiting for the answers.  Blank lines and
+//      lines starting with # get no answer.  Each connection has its own session: a
+//      board, the starting squares, and a Game once a goal is set.  The requests are
+//
+//          board <file>                 load a board definition file, and its robots
+//          pack <file> <index>          load board number index of a board pack, and its robots
+//          robots <r1> <r2> <r3> <r4>   set the starting squares, restarting the game
+//          goal <robot> <letter>        start a game from the starting squares
+//          move <moves...>              make moves in the game, as in move 2L 1U
+//          undo                         take back the last move
+//          solve                        solve from the game's position
+//          hint                         the first move of a shortest solution from there
+//          validate <moves...>          check a solution from the starting squares
+//
+//      board, pack and robots answer {"ok":true}, and goal, move, undo and robots with
+//      a game answer {"robots":[...],"moves":2,"done":false}.  solve answers as batch
+//      mode does, hint with {"hint":"2L","moves":7,...} ("hint":null if there is no
+//      solution, or the goal is reached), and validate with {"valid":true,"moves":7,
+//      "solved":true} or {"valid":false,"move":3,"error":"..."}.  A request that
+//      fails answers {"error":"..."} and changes nothing.
+//
+//      Board files are read once and shared by every connection until the file
+//      changes, and packs stay open, so a warm board costs no parsing.  One thread
+//      polls the sockets and splits what arrives into lines.  A connection with
+//      requests waiting is handed to one worker of a WorkerPool at a time, which
+//      answers all of them and adds the answers to the connection's output, so a
+//      connection's requests run in order and its session needs no lock, while other
+//      connections are served by the other workers.  Each worker has its own
+//      SolverContext.
+//
+//      The sockets are non-blocking, and only the polling thread sends, as a client
+//      is ready to take more, so a client that doesn't read its answers holds up no
+//      worker.  A connection is no longer read from while it has SERVER_MAX_PENDING_LINES
+//      requests, or SERVER_MAX_PENDING_BYTES of requests and answers, waiting, so
+//      such a client stalls itself rather than growing the server.  A request line
+//      longer than SERVER_MAX_LINE_BYTES drops the connection.
+//
+#if !defined( _WIN32)
+const int DEFAULT_SERVER_PORT = 7714;
+const int SERVER_READ_BYTES = 1 << 16;         // most read from a socket at once
+const size_t SERVER_MAX_LINE_BYTES = 1 << 16;           // longest request line
+const size_t SERVER_MAX_PENDING_LINES = 1024;           // requests waiting before reading stops
+const size_t SERVER_MAX_PENDING_BYTES = 1 << 20;        // request and answer bytes waiting before reading stops
+
+struct ServerSession {
+    shared_ptr< const Board> board;        // latest board loaded, NULL before one is
+    int robots[ NUMBER_OF_ROBOTS + 1];     // starting squares, theRobots layout
+    Game game;                             // game.board is NULL until a goal is set
+};
+
+struct ServerConnection {
+    int socket;
+    string partial;                // start of a line not all received yet, polling thread only
+    bool ended;                    // the client has sent all it will, polling thread only
+    ServerSession session;         // used by one worker at a time
+    mutex lock;                    // guards the rest
+    vector< string> pending;       // lines waiting to be answered
+    size_t pendingBytes;           // their total length
+    bool scheduled;                // waiting for a worker, or held by one
+    string output;                 // answers not sent yet
+    bool dropped;                  // the client has gone, or broke a limit, so answer no more
+
+    explicit ServerConnection( int clientSocket)
+        : socket( clientSocket), ended( false), pendingBytes( 0), scheduled( false), dropped( false) { }
+    ~ServerConnection() { close( socket); }
+};
+
+struct Server {
+    bool useIda;                   // solve with IDA* instead of breadth-first
+    SolutionCache *cache;          // solutions found before, NULL for none
+    bool tcp;                      // listening on a TCP port, not a Unix socket
+
+    // boards loaded so far, shared by all connections
+    mutex boardLock;
+    map< string, pair< time_t, shared_ptr< const BoardRecord> > > boardFiles;  // by file name, with its time
+    map< string, shared_ptr< BoardPack> > packs;                             // by file name
+
+    // connections with requests for a worker
+    mutex queueLock;
+    condition_variable queueReady;
+    queue< shared_ptr< ServerConnection> > waiting;
+
+    int wake[ 2];                  // pipe the workers write to, to wake the polling thread
+};
+
+
+//-------------------------------------------------------------------------------------
+// loadServerBoard()
+//      Find a board for a board or pack request, reading or opening the file the first
+//      time it is asked for, or when a board file has changed.  Returns NULL, with
+//      error set, if it can't be loaded.
+//
+shared_ptr< const BoardRecord> loadServerBoard( Server &server,
+                                                const string &fileName,    // board definition or board pack
+                                                long index,                // board in the pack, -1 for a board file
+                                                string &error)             // why it couldn't be loaded
+{
+    lock_guard< mutex> hold( server.boardLock);
+    if( index < 0) {
+        struct stat status;
+        if( stat( fileName.c_str(), &status) != 0) {
+            error = "board file not found";
+            return NULL;
+        }
+        pair< time_t, shared_ptr< const BoardRecord> > &entry = server.boardFiles[ fileName];
+        if( !entry.second || (entry.first != status.st_mtime)) {
+            shared_ptr< BoardRecord> record( new BoardRecord);
+            ifstream inStream( fileName.c_str());
+            if( !makeBoardRecord( inStream, *record)) {
+                server.boardFiles.erase( fileName);
+                error = "invalid board definition";
+                return NULL;
+            }
+            entry = make_pair( status.st_mtime, shared_ptr< const BoardRecord>( record));
+        }
+        return entry.second;
+    }
+
+    shared_ptr< BoardPack> &pack = server.packs[ fileName];
+    if( !pack) {
+        pack.reset( new BoardPack);
+        if( !pack->open( fileName.c_str())) {
+            server.packs.erase( fileName);
+            error = "invalid board pack";
+            return NULL;
+        }
+    }
+    const BoardRecord *record = pack->record( (uint32_t)index);
+    if( record == NULL) {
+        error = "invalid board pack index";
+        return NULL;
+    }
+    // share ownership of the pack, so the board stays mapped while sessions use it
+    return shared_ptr< const BoardRecord>( pack, record);
+}//end loadServerBoard()
+
+
+// Read a move written as robot and direction, as in 2L
+bool parseMoveWord( const string &word, int &robot, int &direction)
+{
+    if( (word.size() != 2) || (word[ 0] < '1') || (word[ 0] > '0' + NUMBER_OF_ROBOTS)) {
+        return false;
+    }
+    const char *letter = find( DIRECTION_LETTERS, DIRECTION_LETTERS + NUMBER_OF_DIRECTIONS, (char)toupper( word[ 1]));
+    robot = word[ 0] - '0';
+    direction = (int)(letter - DIRECTION_LETTERS);
+    return direction < NUMBER_OF_DIRECTIONS;
+}
+
+
+// Answer with the game's robots, moves made and whether the goal is reached
+string serverGameAnswer( const Game &game)
+{
+    ostringstream answer;
+    answer << "{\"robots\":[";
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        answer << (i > 1 ? "," : "") << game.robots[ i];
+    }
+    answer << "],\"moves\":" << game.history.current << ",\"done\":" << (goalReached( game) ? "true" : "false") << "}";
+    return answer.str();
+}
+
+
+//-------------------------------------------------------------------------------------
+// answerServerRequest() - Carry out one request line and return its JSON answer line
+//
+string answerServerRequest( Server &server,
+                            SolverContext &context,        // this worker's scratch memory
+                            ServerSession &session,        // the connection's session
+                            const string &line)            // the request
+{
+    istringstream words( line);
+    string command;
+    words >> command;
+
+    if( (command == "board") || (command == "pack")) {
+        string fileName;
+        long index = -1;
+        words >> fileName;
+        if( (command == "pack") && (!(words >> index) || (index < 0))) {
+            return "{\"error\":\"invalid board pack index\"}";
+        }
+        string error;
+        shared_ptr< const BoardRecord> record = loadServerBoard( server, fileName, index, error);
+        if( !record) {
+            return "{\"error\":\"" + error + "\"}";
+        }
+        session.board = shared_ptr< const Board>( record, &record->board);
+        for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+            session.robots[ i] = record->robots[ i];
+        }
+        session.game = Game();        // no goal on the new board yet
+        return "{\"ok\":true}";
+    }
+    if( command == "robots") {
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        bool valid = true;
+        robots[ 0] = 0;
+        for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+            valid = valid && (words >> robots[ i]) && (robots[ i] >= 0) && (robots[ i] < BOARD_SIZE);
+            for( int j=1; valid && (j<i); j++) {
+                valid = (robots[ j] != robots[ i]);
+            }
+        }
+        if( !valid) {
+            return "{\"error\":\"invalid robots\"}";
+        }
+        memcpy( session.robots, robots, sizeof( robots));
+        if( !session.game.board) {
+            return "{\"ok\":true}";
+        }
+        startGame( session.game, session.game.board, session.robots, session.game.goalRobot,
+                   session.game.destinationLetter);
+        return serverGameAnswer( session.game);
+    }
+    if( command == "goal") {
+        int robot = 0;
+        string letter;
+        words >> robot >> letter;
+        if( !session.board) {
+            return "{\"error\":\"no board loaded\"}";
+        }
+        if( letter.empty() || !startGame( session.game, session.board, session.robots, robot, letter[ 0])) {
+            return "{\"error\":\"invalid robot or letter\"}";
+        }
+        return serverGameAnswer( session.game);
+    }
+    if( (command != "move") && (command != "undo") && (command != "solve") &&
+        (command != "hint") && (command != "validate")) {
+        return "{\"error\":\"unknown request\"}";
+    }
+
+    // the rest are about the game
+    Game &game = session.game;
+    if( !game.board) {
+        return "{\"error\":\"no goal set\"}";
+    }
+    if( command == "move") {
+        vector< pair< int, int> > moves;
+        string word;
+        while( words >> word) {
+            int robot, direction;
+            if( !parseMoveWord( word, robot, direction)) {
+                return "{\"error\":\"invalid move\"}";
+            }
+            moves.push_back( make_pair( robot, direction));
+        }
+        for( size_t i=0; i<moves.size(); i++) {
+            makeGameMove( game, moves[ i].first, moves[ i].second);
+        }
+        return serverGameAnswer( game);
+    }
+    if( command == "undo") {
+        if( !undoGameMove( game)) {
+            return "{\"error\":\"nothing to undo\"}";
+        }
+        return serverGameAnswer( game);
+    }
+    if( command == "validate") {
+        Game trial;
+        startGame( trial, game.board, session.robots, game.goalRobot, game.destinationLetter);
+        int count = 0;
+        string word;
+        while( words >> word) {
+            int robot, direction;
+            count++;
+            if( !parseMoveWord( word, robot, direction)) {
+                return "{\"valid\":false,\"move\":" + to_string( count) + ",\"error\":\"invalid move\"}";
+            }
+            int from = trial.robots[ robot];
+            if( makeGameMove( trial, robot, direction) == from) {
+                return "{\"valid\":false,\"move\":" + to_string( count) + ",\"error\":\"robot does not move\"}";
+            }
+        }
+        return "{\"valid\":true,\"moves\":" + to_string( count) + ",\"solved\":" +
+               (goalReached( trial) ? "true}" : "false}");
+    }
+
+    // solve or hint, from the game's position
+    vector<SolverMove> solution;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool cached;
+    bool solved = solveWithCache( context, *game.board, game.robots, game.goalRobot, game.goalPosition,
+                                  server.useIda, server.cache, solution, cached);
+    long microseconds = (long)chrono::duration_cast< chrono::microseconds>(
+                                  chrono::steady_clock::now() - start).count();
+    ostringstream answer;
+    answer << "{";
+    if( command == "solve") {
+        writeSolutionJson( answer, solved, solution);
+    }
+    else if( solved && !solution.empty()) {
+        answer << "\"hint\":\"" << solution[ 0].robot << solution[ 0].direction << "\",\"moves\":" << solution.size();
+    }
+    else {
+        answer << "\"hint\":null,\"moves\":" << (solved ? 0 : -1);
+    }
+    answer << ",\"expanded\":" << context.statesExpanded << ",\"microseconds\":" << microseconds
+           << (cached ? ",\"cached\":true}" : "}");
+    return answer.str();
+}//end answerServerRequest()
+
+
+// Wake the polling thread, to send answers or read more requests.  The pipe is
+// non-blocking, and a full pipe already wakes it.
+void wakeServerPoll( Server &server)
+{
+    char byte = 0;
+    ssize_t written = write( server.wake[ 1], &byte, 1);
+    (void)written;
+}
+
+
+//-------------------------------------------------------------------------------------
+// serveConnections()
+//      A worker's job: take connections with requests waiting, answer them in order,
+//      and add the answers to the connection's output for the polling thread to
+//      send.  Runs for as long as the server does.
+//
+void serveConnections( Server &server, SolverContext &context)
+{
+    vector< string> lines;
+    string answers;
+    while( true) {
+        shared_ptr< ServerConnection> connection;
+        {
+            unique_lock< mutex> hold( server.queueLock);
+            server.queueReady.wait( hold, [&]() { return !server.waiting.empty(); });
+            connection = server.waiting.front();
+            server.waiting.pop();
+        }
+
+        // hand over the answers and take the next requests, until no more have
+        // arrived, then let the polling thread hand the connection out again
+        while( true) {
+            bool done;
+            {
+                lock_guard< mutex> hold( connection->lock);
+                if( connection->dropped) {
+                    connection->pending.clear();
+                    connection->pendingBytes = 0;
+                }
+                else {
+                    connection->output += answers;
+                }
+                done = connection->pending.empty();
+                if( done) {
+                    connection->scheduled = false;
+                }
+                else {
+                    lines.swap( connection->pending);
+                    connection->pendingBytes = 0;
+                }
+            }
+            wakeServerPoll( server);
+            if( done) {
+                break;
+            }
+            answers.clear();
+            for( size_t i=0; i<lines.size(); i++) {
+                answers += answerServerRequest( server, context, connection->session, lines[ i]);
+                answers += '\n';
+            }
+            lines.clear();
+        }
+        answers.clear();
+    }
+}//end serveConnections()
+
+
+//-------------------------------------------------------------------------------------
+// queueServerLines()
+//      Add request lines to a connection, and give it to a worker if none has it.
+//
+void queueServerLines( Server &server, const shared_ptr< ServerConnection> &connection, vector< string> &lines)
+{
+    bool schedule;
+    {
+        lock_guard< mutex> hold( connection->lock);
+        for( size_t i=0; i<lines.size(); i++) {
+            connection->pendingBytes += lines[ i].size();
+        }
+        connection->pending.insert( connection->pending.end(), lines.begin(), lines.end());
+        schedule = !connection->scheduled;
+        connection->scheduled = true;
+    }
+    if( schedule) {
+        lock_guard< mutex> hold( server.queueLock);
+        server.waiting.push( connection);
+        server.queueReady.notify_one();
+    }
+    lines.clear();
+}
+
+
+// Send as much of a connection's output as the socket takes now, dropping the
+// connection if the client has gone
+void sendServerOutput( ServerConnection &connection)
+{
+    lock_guard< mutex> hold( connection.lock);
+    while( !connection.output.empty()) {
+        ssize_t written = send( connection.socket, connection.output.data(), connection.output.size(), 0);
+        if( written > 0) {
+            connection.output.erase( 0, written);
+        }
+        else if( (written < 0) && (errno == EINTR)) {
+            continue;
+        }
+        else {
+            if( (written < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                connection.dropped = true;
+                connection.output.clear();
+            }
+            return;
+        }
+    }
+}
+
+
+// Stop answering a connection, and let go of it at the next poll
+void dropServerConnection( ServerConnection &connection)
+{
+    lock_guard< mutex> hold( connection.lock);
+    connection.dropped = true;
+    connection.output.clear();
+}
+
+
+//-------------------------------------------------------------------------------------
+// pollServerSockets()
+//      The polling thread: accept connections, read requests from them, and send
+//      their answers.  A connection is polled for reading while it is under the
+//      limits on requests and answers waiting, and for writing while it has answers
+//      to send.  It is let go of once the client has closed it and every request
+//      has been answered and sent, or at once when it is dropped.
+//
+void pollServerSockets( Server &server, int listener)
+{
+    vector< shared_ptr< ServerConnection> > connections;
+    vector< pollfd> polls;
+    vector< string> lines;
+    vector< char> buffer( SERVER_READ_BYTES);
+    while( true) {
+        polls.resize( 2);
+        polls[ 0].fd = listener;
+        polls[ 1].fd = server.wake[ 0];
+        for( int i=0; i<2; i++) {
+            polls[ i].events = POLLIN;
+            polls[ i].revents = 0;
+        }
+        size_t live = 0;
+        for( size_t i=0; i<connections.size(); i++) {
+            ServerConnection &connection = *connections[ i];
+            pollfd entry;
+            entry.events = 0;
+            entry.revents = 0;
+            {
+                lock_guard< mutex> hold( connection.lock);
+                if( connection.dropped ||
+                    (connection.ended && !connection.scheduled && connection.output.empty())) {
+                    continue;          // closed once its worker, if any, is done with it
+                }
+                if( !connection.ended && (connection.pending.size() < SERVER_MAX_PENDING_LINES) &&
+                    (connection.pendingBytes + connection.output.size() < SERVER_MAX_PENDING_BYTES)) {
+                    entry.events |= POLLIN;
+                }
+                if( !connection.output.empty()) {
+                    entry.events |= POLLOUT;
+                }
+            }
+            entry.fd = (entry.events != 0) ? connection.socket : -1;   // poll skips -1
+            polls.push_back( entry);
+            connections[ live++].swap( connections[ i]);
+        }
+        connections.resize( live);
+
+        if( poll( &polls[ 0], polls.size(), -1) < 0) {
+            if( errno == EINTR) {
+                continue;
+            }
+            cout << "*** Error, polling the server sockets failed.  Exiting..." << endl;
+            exit( -1);
+        }
+        if( polls[ 1].revents != 0) {
+            while( read( server.wake[ 0], &buffer[ 0], buffer.size()) > 0) {
+            }
+        }
+
+        for( size_t i=0; i<connections.size(); i++) {
+            const pollfd &entry = polls[ i+2];
+            if( entry.revents == 0) {
+                continue;
+            }
+            ServerConnection &connection = *connections[ i];
+            if( entry.events & POLLOUT) {
+                sendServerOutput( connection);
+            }
+            if( !(entry.events & POLLIN)) {
+                continue;
+            }
+            ssize_t length = recv( connection.socket, &buffer[ 0], buffer.size(), 0);
+            if( (length < 0) && ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                continue;
+            }
+            if( length < 0) {
+                dropServerConnection( connection);
+                continue;
+            }
+            size_t lineStart = 0;
+            for( ssize_t j=0; j<length; j++) {
+                if( buffer[ j] == '\n') {
+                    connection.partial.append( &buffer[ lineStart], j - lineStart);
+                    lines.push_back( string());
+                    lines.back().swap( connection.partial);
+                    lineStart = j + 1;
+                }
+            }
+            if( length > 0) {
+                connection.partial.append( &buffer[ lineStart], length - lineStart);
+            }
+            else {
+                connection.ended = true;
+                if( !connection.partial.empty()) {
+                    lines.push_back( connection.partial);       // the last line had no newline
+                    connection.partial.clear();
+                }
+            }
+            if( connection.partial.size() > SERVER_MAX_LINE_BYTES) {
+                lines.clear();
+                dropServerConnection( connection);
+                continue;
+            }
+
+            // strip carriage returns, and skip blank lines and comments
+            size_t kept = 0;
+            for( size_t j=0; j<lines.size(); j++) {
+                if( !lines[ j].empty() && (lines[ j][ lines[ j].size() - 1] == '\r')) {
+                    lines[ j].erase( lines[ j].size() - 1);
+                }
+                size_t first = lines[ j].find_first_not_of( " \t");
+                if( (first != string::npos) && (lines[ j][ first] != '#')) {
+                    lines[ kept++].swap( lines[ j]);
+                }
+            }
+            lines.resize( kept);
+            if( !lines.empty()) {
+                queueServerLines( server, connections[ i], lines);
+            }
+        }
+
+        if( polls[ 0].revents != 0) {
+            int client = accept( listener, NULL, NULL);
+            if( client >= 0) {
+                if( server.tcp) {
+                    int on = 1;        // send small answers at once
+                    setsockopt( client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof( on));
+                }
+                fcntl( client, F_SETFL, fcntl( client, F_GETFL) | O_NONBLOCK);
+                connections.push_back( make_shared< ServerConnection>( client));
+            }
+        }
+    }//end while( true...
+}//end pollServerSockets()
+
+
+//-------------------------------------------------------------------------------------
+// openServerSocket()
+//      Listen on a localhost TCP port if address is a number, otherwise on a Unix
+//      domain socket at that path, replacing any socket left there.  Returns the
+//      socket, or -1 if it can't listen.
+//
+int openServerSocket( const string &address, bool &tcp)
+{
+    tcp = !address.empty() && (address.find_first_not_of( "0123456789") == string::npos);
+    int listener = socket( tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    if( listener < 0) {
+        return -1;
+    }
+    int bound;
+    if( tcp) {
+        int on = 1;
+        setsockopt( listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof( on));
+        sockaddr_in where;
+        memset( &where, 0, sizeof( where));
+        where.sin_family = AF_INET;
+        where.sin_port = htons( (uint16_t)atoi( address.c_str()));
+        where.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+        bound = ::bind( listener, (sockaddr *)&where, sizeof( where));
+    }
+    else {
+        sockaddr_un where;
+        memset( &where, 0, sizeof( where));
+        if( address.size() >= sizeof( where.sun_path)) {
+            close( listener);
+            return -1;
+        }
+        where.sun_family = AF_UNIX;
+        strcpy( where.sun_path, address.c_str());
+        unlink( address.c_str());
+        bound = ::bind( listener, (sockaddr *)&where, sizeof( where));
+    }
+    if( (bound != 0) || (listen( listener, SOMAXCONN) != 0)) {
+        close( listener);
+        return -1;
+    }
+    return listener;
+}//end openServerSocket()
+
+
+//-------------------------------------------------------------------------------------
+// runServer() - Answer requests until the program is stopped.  Returns the exit status.
+//
+int runServer( const string &address, bool useIda, SolutionCache *cache)
+{
+    Server server;
+    server.useIda = useIda;
+    server.cache = cache;
+    int listener = openServerSocket( address, server.tcp);
+    if( listener < 0) {
+        cout << "*** Error, can't listen on " << address << ".  Exiting..." << endl;
+        return -1;
+    }
+    if( pipe( server.wake) != 0) {
+        cout << "*** Error, can't make the server's wake-up pipe.  Exiting..." << endl;
+        close( listener);
+        return -1;
+    }
+    for( int i=0; i<2; i++) {
+        fcntl( server.wake[ i], F_SETFL, fcntl( server.wake[ i], F_GETFL) | O_NONBLOCK);
+    }
+    signal( SIGPIPE, SIG_IGN);       // a client that has gone is seen by send() instead
+    cout << "Listening on " << (server.tcp ? "port " : "socket ") << address << endl;
+
+    WorkerPool pool;
+    vector< SolverContext> contexts( pool.size());
+    thread poller( pollServerSockets, ref( server), listener);
+    pool.run( [&]( int worker) {
+        serveConnections( server, contexts[ worker]);
+    });
+    poller.join();
+    return 0;
+}//end runServer()
+#else
+const int DEFAULT_SERVER_PORT = 7714;
+
+int runServer( const string &address, bool useIda, SolutionCache *cache)
+{
+    cout << "Server mode is not available in this build.  Exiting..." << endl;
+    return -1;
+}
+#endif
+
+
+//-------------------------------------------------------------------------------------
+// Validating game record files
+//      RicoRobots -validate checks every game in record files, on all cores.  Each
+//      file is memory-mapped.  One pass steps from record to record, noting where
+//      every GAME_RECORD_CHUNK-th record starts, then the workers take chunks of
+//      records with takeChunk() and replay them with checkGameRecord().  A record's
+//      board is found by its hash, once per run of records on the same board.
+//
+const size_t GAME_RECORD_CHUNK = 4096;           // records a worker takes at a time
+const size_t GAME_RECORD_ERRORS_SHOWN = 10;      // invalid records listed for each file
+
+// Compiled boards by boardHash()
+typedef unordered_map< uint64_t, const Board *> GameRecordBoards;
+
+// An invalid record: its number in the file, from 0, and what is wrong with it
+struct GameRecordError {
+    size_t record;
+    const char *reason;
+};
+
+// What one worker found, on cache lines of its own
+struct alignas( 64) GameRecordTally {
+    long valid;
+    long moves;                                  // moves claimed by the records checked
+    vector< GameRecordError> errors;             // the first GAME_RECORD_ERRORS_SHOWN
+};
+
+
+//-------------------------------------------------------------------------------------
+// checkGameRecords()
+//      Check the records in image, size bytes that follow the file header, on every
+//      worker of pool.  Adds the records checked, the valid ones and their moves to
+//      the counts, and the first invalid records to errors.  A record cut short by
+//      the end of the image is invalid, and ends the records.
+//
+void checkGameRecords( const unsigned char *image,          // the records
+                       size_t size,                         // bytes in image
+                       const GameRecordBoards &boards,      // boards the games may be played on
+                       WorkerPool &pool,
+                       long &records,                       // counts to add to
+                       long &valid,
+                       long &moves,
+                       vector< GameRecordError> &errors)    // first invalid records, in order
+{
+    // where each chunk of records starts, with the end of the whole records last
+    vector< size_t> chunkStarts;
+    size_t offset = 0;
+    size_t count = 0;
+    while( offset < size) {
+        if( (size - offset < (size_t)GAME_RECORD_START_BYTES) ||
+            (size - offset < GAME_RECORD_START_BYTES + gameRecordMoveBytes( gameRecordMoveCount( image + offset)))) {
+            break;
+        }
+        if( (count % GAME_RECORD_CHUNK) == 0) {
+            chunkStarts.push_back( offset);
+        }
+        offset += GAME_RECORD_START_BYTES + gameRecordMoveBytes( gameRecordMoveCount( image + offset));
+        count++;
+    }
+    chunkStarts.push_back( offset);
+
+    vector< GameRecordTally> tallies( pool.size());
+    atomic< size_t> nextChunk( 0);
+    pool.run( [&]( int worker) {
+        GameRecordTally &tally = tallies[ worker];
+        tally.valid = 0;
+        tally.moves = 0;
+        const Board *board = NULL;
+        uint64_t hash = 0;
+        size_t begin, end;
+        while( takeChunk( nextChunk, chunkStarts.size() - 1, 1, begin, end)) {
+            size_t record = begin * GAME_RECORD_CHUNK;
+            for( size_t at=chunkStarts[ begin]; at<chunkStarts[ begin + 1]; record++) {
+                const unsigned char *bytes = image + at;
+                int moveCount = gameRecordMoveCount( bytes);
+                at += GAME_RECORD_START_BYTES + gameRecordMoveBytes( moveCount);
+                uint64_t recordHash;
+                memcpy( &recordHash, bytes, sizeof( recordHash));
+                if( (board == NULL) || (recordHash != hash)) {
+                    GameRecordBoards::const_iterator found = boards.find( recordHash);
+                    board = (found != boards.end()) ? found->second : NULL;
+                    hash = recordHash;
+                }
+                const char *reason = (board != NULL) ? checkGameRecord( *board, bytes) : "the board isn't known";
+                if( reason == NULL) {
+                    tally.valid++;
+                    tally.moves += moveCount;
+                }
+                else if( tally.errors.size() < GAME_RECORD_ERRORS_SHOWN) {
+                    GameRecordError error = { record, reason };
+                    tally.errors.push_back( error);
+                }
+            }
+        }
+    });
+
+    size_t firstError = errors.size();
+    for( size_t i=0; i<tallies.size(); i++) {
+        valid += tallies[ i].valid;
+        moves += tallies[ i].moves;
+        errors.insert( errors.end(), tallies[ i].errors.begin(), tallies[ i].errors.end());
+    }
+    if( offset < size) {
+        GameRecordError error = { count, "the file ends in the middle of the record" };
+        errors.push_back( error);
+        count++;
+    }
+    sort( errors.begin() + firstError, errors.end(),
+          []( const GameRecordError &a, const GameRecordError &b) { return a.record < b.record; });
+    errors.resize( min( errors.size(), firstError + GAME_RECORD_ERRORS_SHOWN));
+    records += (long)count;
+}//end checkGameRecords()
+
+
+//-------------------------------------------------------------------------------------
+// validateGameRecords()
+//      Check every record of the game record files, and report the invalid ones and
+//      the moves replayed each second.  Returns 0 if every game is valid.
+//
+int validateGameRecords( char *fileNames[],                  // game record files
+                         int fileCount,
+                         const GameRecordBoards &boards)     // boards the games may be played on
+{
+    WorkerPool pool;
+    long totalRecords = 0;
+    long totalValid = 0;
+    long totalMoves = 0;
+    double microseconds = 0;
+    for( int file=0; file<fileCount; file++) {
+        const char *fileName = fileNames[ file];
+        struct stat fileStatus;
+        if( (stat( fileName, &fileStatus) != 0) || ((size_t)fileStatus.st_size < sizeof( GameRecordFileHeader))) {
+            cout << "Game record file " << fileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        size_t fileSize = (size_t)fileStatus.st_size;
+#if !defined( _WIN32)
+        int fileHandle = ::open( fileName, O_RDONLY);
+        void *mapping = (fileHandle >= 0) ? mmap( NULL, fileSize, PROT_READ, MAP_SHARED, fileHandle, 0) : MAP_FAILED;
+        if( fileHandle >= 0) {
+            ::close( fileHandle);         // the mapping stays valid
+        }
+        if( mapping == MAP_FAILED) {
+            cout << "Game record file " << fileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        madvise( mapping, fileSize, MADV_SEQUENTIAL);
+        const unsigned char *image = (const unsigned char *)mapping;
+#else
+        vector< unsigned char> readImage( fileSize);
+        ifstream inStream( fileName, ios::binary);
+        inStream.read( (char *)&readImage[ 0], fileSize);
+        const unsigned char *image = &readImage[ 0];
+#endif
+        GameRecordFileHeader expected = { GAME_RECORD_MAGIC, GAME_RECORD_VERSION, BOARD_EDGE, NUMBER_OF_ROBOTS };
+        bool matches = (memcmp( image, &expected, sizeof( expected)) == 0);
+        long records = 0;
+        long valid = 0;
+        vector< GameRecordError> errors;
+        if( matches) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            checkGameRecords( image + sizeof( expected), fileSize - sizeof( expected), boards, pool,
+                              records, valid, totalMoves, errors);
+            microseconds += microsecondsSince( start);
+        }
+#if !defined( _WIN32)
+        munmap( mapping, fileSize);
+#endif
+        if( !matches) {
+            cout << "Game record file " << fileName << " is not from this board size and number of robots.  Exiting..." << endl;
+            return -1;
+        }
+
+        cout << fileName << ": " << records << " games, " << valid << " valid, " << records - valid << " invalid" << endl;
+        for( size_t i=0; i<errors.size(); i++) {
+            cout << "  game " << errors[ i].record << ": " << errors[ i].reason << endl;
+        }
+        if( records - valid > (long)errors.size()) {
+            cout << "  ..." << endl;
+        }
+        totalRecords += records;
+        totalValid += valid;
+    }
+    cout << "Replayed " << totalMoves << " moves in " << microseconds / 1000 << " ms";
+    if( microseconds > 0) {
+        cout << " (" << totalMoves / microseconds << " million moves per second)";
+    }
+    cout << endl;
+    return (totalValid == totalRecords) ? 0 : -1;
+}//end validateGameRecords()
+
+
+//-------------------------------------------------------------------------------------
+// Random numbers for the puzzle generator
+//      Each worker has its own xorshift64* generator, so no state is shared between
+//      threads.  A generator is seeded from the run's seed and a sample number with
+//      splitmix64, so each sample gets the same random numbers whichever worker takes
+//      it, and the output doesn't depend on the number of threads.
+//
+struct RandomGenerator {
+    uint64_t state;          // never 0
+};
+
+// Seed a generator for one sample of a run
+inline void randomSeed( RandomGenerator &generator, uint64_t seed, uint64_t sampleNumber)
+{
+    // one splitmix64 step on the combined seed
+    uint64_t z = seed * 0x9E3779B97F4A7C15ULL + sampleNumber + 1;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    generator.state = (z != 0) ? z : 1;
+}
+
+// Next random number from 0 to limit-1
+inline int randomBelow( RandomGenerator &generator, int limit)
+{
+    generator.state ^= generator.state >> 12;
+    generator.state ^= generator.state << 25;
+    generator.state ^= generator.state >> 27;
+    uint64_t value = generator.state * 0x2545F4914F6CDD1DULL;
+    return (int)(((value >> 32) * (uint64_t)limit) >> 32);
+}
+
+
+//-------------------------------------------------------------------------------------
+// rateStartPosition()
+//      Find how many moves every goal takes from one starting position, with a single
+//      breadth-first search.  optimalMoves[ robot][ letter] is set to the fewest moves
+//      that stop that robot on that letter's square, or UNREACHABLE if it takes more
+//      than maxMoves.  The search stops early once every goal has been reached.
+//
+void rateStartPosition( SolverContext &context,                        // reusable scratch memory
+                        const Board &board,                             // compiled board
+                        const int startRobots[ NUMBER_OF_ROBOTS + 1],   // robot positions, theRobots layout
+                        int maxMoves,                                   // deepest search
+                        unsigned char optimalMoves[ NUMBER_OF_ROBOTS + 1][ NUMBER_OF_LETTERS])
+{
+    // letter on each square, and the number of goals still to be reached
+    signed char letterAt[ BOARD_SIZE];
+    memset( letterAt, -1, sizeof( letterAt));
+    memset( optimalMoves, UNREACHABLE, (NUMBER_OF_ROBOTS + 1) * NUMBER_OF_LETTERS);
+    int goalsLeft = 0;
+    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+        if( board.targets[ letter] >= 0) {
+            letterAt[ board.targets[ letter]] = (signed char)letter;
+            goalsLeft += NUMBER_OF_ROBOTS;
+        }
+    }
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        if( letterAt[ startRobots[ robot]] >= 0) {
+            optimalMoves[ robot][ letterAt[ startRobots[ robot]]] = 0;
+            goalsLeft--;
+        }
+    }
+
+    context.stateKeys.clear();
+    fill( context.visited.begin(), context.visited.end(), 0);
+    context.visitedCount = 0;
+    context.statesExpanded = 0;
+
+    StateKey startKey = packRobots( startRobots);
+    context.stateKeys.push_back( startKey);
+    visitedInsert( context, startKey);
+
+    size_t levelStart = 0;       // first state of the depth being expanded
+    for( int depth=0; (depth < maxMoves) && (goalsLeft > 0); depth++) {
+        size_t levelEnd = context.stateKeys.size();
+        for( size_t index=levelStart; index<levelEnd; index++) {
+            StateKey successors[ MAX_SUCCESSORS];
+            unsigned char successorMoves[ MAX_SUCCESSORS];
+            int count = generateSuccessors( board, context.stateKeys[ index], successors, successorMoves);
+            context.statesExpanded++;
+            for( int i=0; i<count; i++) {
+                if( !visitedInsert( context, successors[ i])) {
+                    continue;      // already reached in as few moves
+                }
+                context.stateKeys.push_back( successors[ i]);
+                // only the robot that moved can have reached a new goal
+                int robot = successorMoves[ i] / NUMBER_OF_DIRECTIONS + 1;
+                int letter = letterAt[ robotPosition( successors[ i], robot)];
+                if( (letter >= 0) && (optimalMoves[ robot][ letter] == UNREACHABLE)) {
+                    optimalMoves[ robot][ letter] = (unsigned char)(depth + 1);
+                    goalsLeft--;
+                }
+            }
+        }
+        levelStart = levelEnd;
+    }
+}//end rateStartPosition()
+
+
+//-------------------------------------------------------------------------------------
+// Puzzle generator
+//      RicoRobots -generate <moves> <count> [-seed n] [-samples n] [-pack file index]
+//      Samples random robot placements on the board, finds the fewest moves for every
+//      robot and letter from each placement, and writes count different puzzles whose
+//      shortest solution is exactly moves long.  The output is batch mode input:
+//
+//          pack board.rrb 0             the board, compiled (board.txt's cache by default)
+//          # 1000 puzzles of 12 moves, seed 1
+//          robots <r1> <r2> <r3> <r4>
+//          goal <robot> <letter>
+//          ...
+//
+//      Samples are rated in rounds across a WorkerPool, and the puzzles found are
+//      taken in sample order, so a seed always gives the same puzzles.  The number of
+//      goals seen at each length is written to standard error at the end, and
+//      progress every GENERATOR_PROGRESS_SECONDS while it runs.  At most -samples
+//      placements are tried, GENERATOR_DEFAULT_SAMPLES_PER_PUZZLE for each puzzle
+//      wanted by default, so a length that the board rarely or never has ends with
+//      an error and the lengths that were seen, rather than running forever.
+//
+const int GENERATOR_SAMPLES_PER_WORKER = 16;      // samples per worker in each round
+const long GENERATOR_DEFAULT_SAMPLES_PER_PUZZLE = 100;
+const double GENERATOR_PROGRESS_SECONDS = 10;
+
+struct GeneratedPuzzle {
+    int robots[ NUMBER_OF_ROBOTS + 1];     // starting squares, theRobots layout
+    int goalRobot;
+    char destinationLetter;
+};
+
+
+//-------------------------------------------------------------------------------------
+// generatePuzzles() - Generate the puzzles and write them.  Returns the exit status.
+//
+int generatePuzzles( const Board &board,          // compiled board to generate puzzles on
+                     const string &packLine,      // batch line that selects this board
+                     int moves,                   // length of the shortest solution wanted
+                     long count,                  // number of puzzles wanted
+                     uint64_t seed,               // seeds the random placements
+                     uint64_t samples)            // most placements to try
+{
+    WorkerPool pool;
+    vector< SolverContext> contexts( pool.size());
+    vector< RandomGenerator> generators( pool.size());
+    size_t roundSize = (size_t)pool.size() * GENERATOR_SAMPLES_PER_WORKER;
+    vector< vector< GeneratedPuzzle> > found( roundSize);        // puzzles from each sample of a round
+    vector< long> lengthCounts( moves + 2, 0);                   // goals seen at each length, last is longer
+    vector< vector< long> > workerLengthCounts( pool.size(), vector< long>( moves + 2, 0));
+    unordered_set< uint64_t> seen;                               // puzzles already written
+    uint64_t sampleNumber = 0;
+    long written = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::steady_clock::time_point lastProgress = start;
+
+    cout << packLine << "\n# " << count << " puzzles of " << moves << " moves, seed " << seed << "\n";
+    while( (written < count) && (sampleNumber < samples)) {
+        // rate a round of samples
+        size_t thisRound = (size_t)min( (uint64_t)roundSize, samples - sampleNumber);
+        atomic< size_t> nextSample( 0);
+        pool.run( [&]( int worker) {
+            RandomGenerator &generator = generators[ worker];
+            size_t begin, end;
+            while( takeChunk( nextSample, thisRound, 1, begin, end)) {
+                randomSeed( generator, seed, sampleNumber + begin);
+                GeneratedPuzzle puzzle;
+                puzzle.robots[ 0] = 0;
+                for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+                    bool taken;
+                    do {
+                        puzzle.robots[ i] = randomBelow( generator, BOARD_SIZE);
+                        taken = false;
+                        for( int j=1; j<i; j++) {
+                            taken = taken || (puzzle.robots[ j] == puzzle.robots[ i]);
+                        }
+                    } while( taken);
+                }
+
+                unsigned char optimalMoves[ NUMBER_OF_ROBOTS + 1][ NUMBER_OF_LETTERS];
+                rateStartPosition( contexts[ worker], board, puzzle.robots, moves, optimalMoves);
+                found[ begin].clear();
+                for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+                    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+                        if( board.targets[ letter] < 0) {
+                            continue;
+                        }
+                        workerLengthCounts[ worker][ min( (int)optimalMoves[ robot][ letter], moves + 1)]++;
+                        if( optimalMoves[ robot][ letter] == moves) {
+                            puzzle.goalRobot = robot;
+                            puzzle.destinationLetter = (char)('A' + letter);
+                            found[ begin].push_back( puzzle);
+                        }
+                    }
+                }
+            }
+        });
+        sampleNumber += thisRound;
+
+        // write the new puzzles in sample order
+        for( size_t i=0; (i < thisRound) && (written < count); i++) {
+            for( size_t j=0; (j < found[ i].size()) && (written < count); j++) {
+                const GeneratedPuzzle &puzzle = found[ i][ j];
+                uint64_t puzzleKey = ((uint64_t)packRobots( puzzle.robots) << 8) |
+                                     (uint64_t)(puzzle.goalRobot << 5) | (uint64_t)(puzzle.destinationLetter - 'A');
+                if( !seen.insert( puzzleKey).second) {
+                    continue;      // already written
+                }
+                cout << "robots";
+                for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+                    cout << " " << puzzle.robots[ robot];
+                }
+                cout << "\ngoal " << puzzle.goalRobot << " " << puzzle.destinationLetter << "\n";
+                written++;
+            }
+        }
+        cout.flush();
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if( chrono::duration< double>( now - lastProgress).count() >= GENERATOR_PROGRESS_SECONDS) {
+            lastProgress = now;
+            cerr << "Found " << written << " of " << count << " puzzles from " << sampleNumber << " of at most "
+                 << samples << " placements..." << endl;
+        }
+    }
+
+    // summary of the goals seen at each length
+    for( int worker=0; worker<pool.size(); worker++) {
+        for( int length=0; length<=moves+1; length++) {
+            lengthCounts[ length] += workerLengthCounts[ worker][ length];
+        }
+    }
+    double seconds = chrono::duration< double>( chrono::steady_clock::now() - start).count();
+    if( written < count) {
+        cerr << "*** Error, only " << written << " of " << count << " puzzles of " << moves
+             << " moves were found in " << samples << " placements (-samples to try more)." << endl;
+    }
+    cerr << "Wrote " << written << " puzzles from " << sampleNumber << " placements in " << seconds << " seconds." << endl;
+    cerr << "Goals by shortest solution:";
+    for( int length=0; length<=moves; length++) {
+        cerr << " " << length << ":" << lengthCounts[ length];
+    }
+    cerr << " more:" << lengthCounts[ moves + 1] << endl;
+    return (written < count) ? -1 : 0;
+}//end generatePuzzles()
+
+
+//-------------------------------------------------------------------------------------
+// Differential fuzzing
+//      RicoRobots -fuzz [comparisons] [-seed n]
+//      Checks the fast move code against the one-square rule it replaced, on random
+//      boards and placements on every core.  For each robot and direction the legacy
+//      loop steps the robot one square at a time with fuzzCanMove(), the original
+//      canMove() rule, until it is stopped, and slideRobot() and generateSuccessors()
+//      must give the same square.
+//
+//      A board's walls are given on random squares and sides, so a wall is as often
+//      given on the square moved into as on the square moved from.  The legacy side
+//      keeps them as given, in a FuzzBaseline laid out like the original theBoard, and
+//      checks both the side of the square moved from and the opposite side of the
+//      square moved into, so it shares nothing with addWall(), the Board walls or
+//      compileBoard(), which build the tables the fast side uses.  Most robots are put on the row or column of an earlier
+//      robot, so many moves are cut short by a robot.  Boards are seeded by number,
+//      like the generator's samples, so a run finds the same boards whatever the
+//      number of threads.
+//
+//      The first mismatch is shrunk by taking away walls for as long as some move
+//      still disagrees, and written as a board definition, with the move and the
+//      squares each side gave.  Returns -1 if there was a mismatch.
+//
+const int FUZZ_PLACEMENTS = 64;                      // placements tried on each board
+const long FUZZ_DEFAULT_COMPARISONS = 100000000;     // moves compared by default
+
+// A wall as given, before addWall() records it on both squares
+struct FuzzWall {
+    unsigned char square;
+    unsigned char direction;
+};
+
+// The walls of a board as given, with the edges, one entry per side of each square as
+// in the original theBoard.  A wall given on one square is not copied to its neighbor.
+struct FuzzBaseline {
+    bool wall[ BOARD_SIZE][ NUMBER_OF_DIRECTIONS];
+};
+
+// One move the two sides disagree on
+struct FuzzMismatch {
+    int robot;
+    int direction;
+    int legacy;                  // where the original rule stops the robot
+    int slide;                   // where slideRobot() does
+    int successor;               // where generateSuccessors() does, from if it has no such move
+};
+
+// What one worker found, on cache lines of its own
+struct alignas( 64) FuzzTally {
+    long comparisons;
+    long mismatches;
+    uint64_t firstBoard;                     // lowest board number with a mismatch
+    vector< FuzzWall> walls;                 // that board's walls
+    int robots[ NUMBER_OF_ROBOTS + 1];       // and placement
+};
+
+
+//-------------------------------------------------------------------------------------
+// buildFuzzBoard()
+//      Create a board with the given walls and compile it, and record the walls as
+//      given, with the board's edges, for the original rule.
+//
+void buildFuzzBoard( const vector< FuzzWall> &walls, FuzzBaseline &baseline, Board &board)
+{
+    createBoard( board);
+    for( size_t i=0; i<walls.size(); i++) {
+        addWall( board, walls[ i].square, walls[ i].direction);
+    }
+    compileBoard( board);
+
+    memset( baseline.wall, 0, sizeof( baseline.wall));
+    for( int square=0; square<BOARD_SIZE; square++) {
+        baseline.wall[ square][ LEFT] = (square % BOARD_EDGE) == 0;
+        baseline.wall[ square][ ABOVE] = square < BOARD_EDGE;
+        baseline.wall[ square][ RIGHT] = (square % BOARD_EDGE) == BOARD_EDGE - 1;
+        baseline.wall[ square][ BELOW] = square >= BOARD_SIZE - BOARD_EDGE;
+    }
+    for( size_t i=0; i<walls.size(); i++) {
+        baseline.wall[ walls[ i].square][ walls[ i].direction] = true;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// fuzzCanMove()
+//      The original canMove() rule: a robot can move one square if there is no wall
+//      on its own side or on the neighbor's opposite side, and no robot on the neighbor.
+//
+bool fuzzCanMove( const FuzzBaseline &baseline,
+                  const int robots[ NUMBER_OF_ROBOTS + 1],      // placement, theRobots layout
+                  int from,
+                  int direction)
+{
+    int neighbor = from + DIRECTION_OFFSETS[ direction];
+    if( (neighbor < 0) || (neighbor >= BOARD_SIZE)) {
+        return false;
+    }
+    if( baseline.wall[ from][ direction] || baseline.wall[ neighbor][ OPPOSITE_DIRECTION[ direction]]) {
+        return false;
+    }
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        if( robots[ robot] == neighbor) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// findFuzzMismatch()
+//      Compare every move of a placement.  Adds the moves compared to comparisons, and
+//      returns true, with the first move that disagrees, if any does.
+//
+bool findFuzzMismatch( const FuzzBaseline &baseline,                 // walls as given, for the original rule
+                       const Board &board,                           // compiled board
+                       const int robots[ NUMBER_OF_ROBOTS + 1],      // placement, theRobots layout
+                       long &comparisons,
+                       FuzzMismatch &mismatch)
+{
+    StateKey key = packRobots( robots);
+    StateKey successors[ MAX_SUCCESSORS];
+    unsigned char successorMoves[ MAX_SUCCESSORS];
+    int count = generateSuccessors( board, key, successors, successorMoves);
+
+    int next = 0;                // the successor that should be the next move
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            int legacy = robots[ robot];
+            while( fuzzCanMove( baseline, robots, legacy, direction)) {
+                legacy += DIRECTION_OFFSETS[ direction];
+            }
+            int successor = robots[ robot];
+            if( (next < count) && (successorMoves[ next] == (robot - 1) * NUMBER_OF_DIRECTIONS + direction)) {
+                successor = robotPosition( successors[ next++], robot);
+            }
+            int slide = slideRobot( board, key, robot, direction);
+            comparisons++;
+            if( (slide != legacy) || (successor != legacy)) {
+                mismatch.robot = robot;
+                mismatch.direction = direction;
+                mismatch.legacy = legacy;
+                mismatch.slide = slide;
+                mismatch.successor = successor;
+                return true;
+            }
+        }
+    }
+    if( next != count) {
+        // a successor for a move that leaves its robot where it is, or out of order
+        int robot = successorMoves[ next] / NUMBER_OF_DIRECTIONS + 1;
+        mismatch.robot = robot;
+        mismatch.direction = successorMoves[ next] % NUMBER_OF_DIRECTIONS;
+        mismatch.legacy = robots[ robot];
+        mismatch.slide = slideRobot( board, key, robot, mismatch.direction);
+        mismatch.successor = robotPosition( successors[ next], robot);
+        return true;
+    }
+    return false;
+}//end findFuzzMismatch()
+
+
+//-------------------------------------------------------------------------------------
+// makeFuzzCase()
+//      Random walls for board number boardNumber, and a generator to place robots on
+//      it with placeFuzzRobots().  From none to about one wall per square, most boards
+//      with few.
+//
+void makeFuzzCase( uint64_t seed, uint64_t boardNumber, vector< FuzzWall> &walls, RandomGenerator &generator)
+{
+    randomSeed( generator, seed, boardNumber);
+    int wallCount = randomBelow( generator, BOARD_SIZE + 1) >> randomBelow( generator, 4);
+    walls.resize( wallCount);
+    for( int i=0; i<wallCount; i++) {
+        walls[ i].square = (unsigned char)randomBelow( generator, BOARD_SIZE);
+        walls[ i].direction = (unsigned char)randomBelow( generator, NUMBER_OF_DIRECTIONS);
+    }
+}
+
+void placeFuzzRobots( RandomGenerator &generator, int robots[ NUMBER_OF_ROBOTS + 1])
+{
+    robots[ 0] = 0;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        bool taken;
+        do {
+            robots[ i] = randomBelow( generator, BOARD_SIZE);
+            if( (i > 1) && (randomBelow( generator, 4) != 0)) {
+                // on the row or column of an earlier robot
+                int other = robots[ 1 + randomBelow( generator, i - 1)];
+                robots[ i] = (randomBelow( generator, 2) == 0)
+                    ? (other / BOARD_EDGE) * BOARD_EDGE + robots[ i] % BOARD_EDGE
+                    : (robots[ i] / BOARD_EDGE) * BOARD_EDGE + other % BOARD_EDGE;
+            }
+            taken = false;
+            for( int j=1; j<i; j++) {
+                taken = taken || (robots[ j] == robots[ i]);
+            }
+        } while( taken);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// shrinkFuzzMismatch()
+//      Take away walls one at a time, keeping each removal after which some move of
+//      the placement still disagrees, until none can go.  Returns the mismatch left.
+//
+FuzzMismatch shrinkFuzzMismatch( vector< FuzzWall> &walls, const int robots[ NUMBER_OF_ROBOTS + 1])
+{
+    FuzzBaseline baseline;
+    Board board;
+    FuzzMismatch mismatch;
+    long comparisons = 0;
+    buildFuzzBoard( walls, baseline, board);
+    findFuzzMismatch( baseline, board, robots, comparisons, mismatch);
+    bool shrunk = true;
+    while( shrunk) {
+        shrunk = false;
+        for( size_t i=walls.size(); i>0; i--) {
+            vector< FuzzWall> fewer( walls);
+            fewer.erase( fewer.begin() + (i - 1));
+            FuzzMismatch left;
+            buildFuzzBoard( fewer, baseline, board);
+            if( findFuzzMismatch( baseline, board, robots, comparisons, left)) {
+                walls.swap( fewer);
+                mismatch = left;
+                shrunk = true;
+            }
+        }
+    }
+    return mismatch;
+}//end shrinkFuzzMismatch()
+
+
+//-------------------------------------------------------------------------------------
+// writeFuzzMismatch()
+//      Write a mismatch as a board definition in the board.txt format, with 'A' on
+//      the square the legacy rule stops at, then the move and each side's answer.
+//
+void writeFuzzMismatch( ostream &out, const vector< FuzzWall> &walls, const int robots[ NUMBER_OF_ROBOTS + 1],
+                        const FuzzMismatch &mismatch)
+{
+    // the walls given on each square, with the letter's square listed too
+    map< int, string> squares;
+    squares[ mismatch.legacy] = "0 0 0 0";
+    for( size_t i=0; i<walls.size(); i++) {
+        string &sides = squares.insert( make_pair( (int)walls[ i].square, string( "0 0 0 0"))).first->second;
+        sides[ 2 * walls[ i].direction] = '1';
+    }
+    out << "1\n" << squares.size() << "\n";
+    for( map< int, string>::const_iterator square=squares.begin(); square!=squares.end(); ++square) {
+        out << square->first << " " << square->second << (square->first == mismatch.legacy ? " A" : "") << "\n";
+    }
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        out << robots[ robot] << "  robot " << robot << "\n";
+    }
+    out << "Move " << mismatch.robot << DIRECTION_LETTERS[ mismatch.direction] << " from " << robots[ mismatch.robot]
+        << ": the original rule stops at " << mismatch.legacy << ", slideRobot() at " << mismatch.slide
+        << ", generateSuccessors() at " << mismatch.successor << endl;
+}//end writeFuzzMismatch()
+
+
+//-------------------------------------------------------------------------------------
+// runFuzz() - Compare at least comparisons moves.  Returns the exit status.
+//
+int runFuzz( long comparisons, uint64_t seed)
+{
+    WorkerPool pool;
+    vector< FuzzTally> tallies( pool.size());
+    uint64_t boardCount = ((uint64_t)comparisons + FUZZ_PLACEMENTS * MAX_SUCCESSORS - 1) /
+                          (FUZZ_PLACEMENTS * MAX_SUCCESSORS);
+    atomic< size_t> nextBoard( 0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    pool.run( [&]( int worker) {
+        FuzzTally &tally = tallies[ worker];
+        tally.comparisons = 0;
+        tally.mismatches = 0;
+        tally.firstBoard = boardCount;
+        vector< FuzzWall> walls;
+        RandomGenerator generator;
+        FuzzBaseline baseline;
+        Board board;
+        size_t begin, end;
+        while( takeChunk( nextBoard, (size_t)boardCount, 1, begin, end)) {
+            makeFuzzCase( seed, begin, walls, generator);
+            buildFuzzBoard( walls, baseline, board);
+            for( int placement=0; placement<FUZZ_PLACEMENTS; placement++) {
+                int robots[ NUMBER_OF_ROBOTS + 1];
+                FuzzMismatch mismatch;
+                placeFuzzRobots( generator, robots);
+                if( !findFuzzMismatch( baseline, board, robots, tally.comparisons, mismatch)) {
+                    continue;
+                }
+                tally.mismatches++;
+                if( begin < tally.firstBoard) {
+                    tally.firstBoard = begin;
+                    tally.walls = walls;
+                    memcpy( tally.robots, robots, sizeof( tally.robots));
+                }
+            }
+        }
+    });
+    double seconds = chrono::duration< double>( chrono::steady_clock::now() - start).count();
+
+    long compared = 0;
+    long mismatches = 0;
+    const FuzzTally *first = NULL;
+    for( size_t i=0; i<tallies.size(); i++) {
+        compared += tallies[ i].comparisons;
+        mismatches += tallies[ i].mismatches;
+        if( (tallies[ i].mismatches > 0) && ((first == NULL) || (tallies[ i].firstBoard < first->firstBoard))) {
+            first = &tallies[ i];
+        }
+    }
+    cout << "Compared " << compared << " moves on " << boardCount << " boards, seed " << seed << ", in "
+         << seconds << " s (" << compared / seconds / 1e6 << " million comparisons per second).  "
+         << mismatches << " placements disagree." << endl;
+    if( first == NULL) {
+        return 0;
+    }
+    vector< FuzzWall> walls( first->walls);
+    FuzzMismatch mismatch = shrinkFuzzMismatch( walls, first->robots);
+    cout << "First mismatch, on board " << first->firstBoard << ", shrunk to " << walls.size() << " walls:" << endl;
+    writeFuzzMismatch( cout, walls, first->robots, mismatch);
+    return -1;
+}//end runFuzz()
+
+
+//-------------------------------------------------------------------------------------
+// Assembly fuzzing
+//      RicoRobots -fuzz -assembly [sets] [-seed n]
+//      RicoRobots -fuzz -assembly quadrants.txt
+//      Checks assembleLayout() against compiling the board it puts together: for
+//      every layout, the walls it ORs from the quadrants are given to compileBoard(),
+//      which steps each slide square by square, and the two slideStop tables must
+//      agree.  A random set is both sides of four tiles, each side with random walls
+//      given on random squares and sides of the quadrant, so some are on the middle
+//      of the board and some stop slides on their way into the next quadrant.  Sets
+//      are seeded by number like the fuzzer's boards.  Given a quadrant file, every
+//      layout of the file is checked instead.
+//
+//      The first mismatch is written as the quadrant file of its set, with the layout
+//      and the slide.  Returns -1 if there was a mismatch.
+//
+const long FUZZ_DEFAULT_QUADRANT_SETS = 10000;       // random quadrant sets checked by default
+const int FUZZ_QUADRANT_TILES = 4;                   // tiles in a random set, two sides each
+
+// One slide the assembled and the compiled board disagree on
+struct AssemblyMismatch {
+    QuadrantLayout layout;
+    int square;
+    int direction;
+    int assembled;               // where assembleLayout()'s table stops the slide
+    int compiled;                // where compileBoard()'s does
+};
+
+// What one worker found, on cache lines of its own
+struct alignas( 64) AssemblyTally {
+    long layouts;
+    long mismatches;
+    uint64_t firstSet;           // lowest set number with a mismatch
+};
+
+
+//-------------------------------------------------------------------------------------
+// makeFuzzQuadrants()
+//      Random walls for each quadrant of set number setNumber, given as they lie in
+//      the top left of the board, and the quadrants placed from them.  Quadrant q is
+//      side 'A' + q % 2 of tile q / 2 + 1.
+//
+void makeFuzzQuadrants( uint64_t seed, uint64_t setNumber,
+                        vector< vector< FuzzWall> > &walls,    // returns each quadrant's walls
+                        vector< Quadrant> &quadrants)          // returns the quadrants, placed
+{
+    RandomGenerator generator;
+    randomSeed( generator, seed, setNumber);
+    walls.resize( 2 * FUZZ_QUADRANT_TILES);
+    quadrants.resize( 2 * FUZZ_QUADRANT_TILES);
+    for( size_t q=0; q<quadrants.size(); q++) {
+        int wallCount = randomBelow( generator, QUADRANT_SIZE + 1) >> randomBelow( generator, 4);
+        walls[ q].resize( wallCount);
+        Board base;
+        createBoard( base);
+        for( int i=0; i<wallCount; i++) {
+            int square = randomBelow( generator, QUADRANT_EDGE) * BOARD_EDGE + randomBelow( generator, QUADRANT_EDGE);
+            walls[ q][ i].square = (unsigned char)square;
+            walls[ q][ i].direction = (unsigned char)randomBelow( generator, NUMBER_OF_DIRECTIONS);
+            addWall( base, square, walls[ q][ i].direction);
+        }
+        quadrants[ q].tile = (int)q / 2 + 1;
+        quadrants[ q].side = (char)('A' + q % 2);
+        placeQuadrant( quadrants[ q], base);
+    }
+}//end makeFuzzQuadrants()
+
+
+//-------------------------------------------------------------------------------------
+// findAssemblyMismatch()
+//      Check every layout of the quadrants.  Adds the layouts checked to checked, and
+//      returns true, with the first slide that disagrees, if any does.  A layout
+//      with a letter in two quadrants can't be assembled, and is skipped.
+//
+bool findAssemblyMismatch( const vector< Quadrant> &quadrants,
+                           const vector< QuadrantLayout> &layouts,
+                           long &checked,
+                           AssemblyMismatch &mismatch)
+{
+    Board assembled;
+    Board compiled;
+    for( size_t i=0; i<layouts.size(); i++) {
+        if( !assembleLayout( quadrants, layouts[ i], assembled)) {
+            continue;
+        }
+        checked++;
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            compiled.walls[ direction] = assembled.walls[ direction];
+        }
+        compileBoard( compiled);
+        for( int square=0; square<BOARD_SIZE; square++) {
+            for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+                if( assembled.slideStop[ square][ direction] != compiled.slideStop[ square][ direction]) {
+                    mismatch.layout = layouts[ i];
+                    mismatch.square = square;
+                    mismatch.direction = direction;
+                    mismatch.assembled = assembled.slideStop[ square][ direction];
+                    mismatch.compiled = compiled.slideStop[ square][ direction];
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}//end findAssemblyMismatch()
+
+
+//-------------------------------------------------------------------------------------
+// writeAssemblyMismatch()
+//      Write a mismatch: the quadrant file of a random set if walls is not empty, then
+//      the layout and the slide the two sides disagree on.
+//
+void writeAssemblyMismatch( ostream &out,
+                            const vector< vector< FuzzWall> > &walls,
+                            const vector< Quadrant> &quadrants,
+                            const AssemblyMismatch &mismatch)
+{
+    if( !walls.empty()) {
+        out << quadrants.size() << "\n";
+        for( size_t q=0; q<quadrants.size(); q++) {
+            // the walls given on each square, numbered across the quadrant
+            map< int, string> squares;
+            for( size_t i=0; i<walls[ q].size(); i++) {
+                int piece = (walls[ q][ i].square / BOARD_EDGE) * QUADRANT_EDGE + walls[ q][ i].square % BOARD_EDGE;
+                string &sides = squares.insert( make_pair( piece, string( "0 0 0 0"))).first->second;
+                sides[ 2 * walls[ q][ i].direction] = '1';
+            }
+            out << quadrants[ q].tile << " " << quadrants[ q].side << " " << squares.size() << "\n";
+            for( map< int, string>::const_iterator square=squares.begin(); square!=squares.end(); ++square) {
+                out << square->first << " " << square->second << "\n";
+            }
+        }
+        for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+            out << robot - 1 << "  robot " << robot << "\n";
+        }
+    }
+    out << "Layout";
+    for( int position=0; position<QUADRANT_POSITIONS; position++) {
+        const Quadrant &quadrant = quadrants[ mismatch.layout.quadrant[ position]];
+        out << " " << quadrant.tile << quadrant.side;
+    }
+    out << ", slide " << DIRECTION_LETTERS[ mismatch.direction] << " from " << mismatch.square
+        << ": assembleLayout() stops at " << mismatch.assembled << ", compileBoard() at " << mismatch.compiled << endl;
+}//end writeAssemblyMismatch()
+
+
+//-------------------------------------------------------------------------------------
+// runAssemblyFuzz()
+//      Check every layout of sets random quadrant sets, or of the quadrant file if
+//      quadrantName is not NULL.  Returns the exit status.
+//
+int runAssemblyFuzz( long sets, uint64_t seed, const char *quadrantName)
+{
+    vector< vector< FuzzWall> > walls;
+    vector< Quadrant> quadrants;
+    vector< QuadrantLayout> layouts;
+    AssemblyMismatch mismatch;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if( quadrantName != NULL) {
+        ifstream inStream( quadrantName);
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        if( inStream.fail() || !readQuadrants( inStream, quadrants, robots)) {
+            cout << "Quadrant file " << quadrantName << " does not hold valid quadrants.  Exiting..." << endl;
+            return -1;
+        }
+        listQuadrantLayouts( quadrants, layouts);
+        long checked = 0;
+        bool found = findAssemblyMismatch( quadrants, layouts, checked, mismatch);
+        double seconds = chrono::duration< double>( chrono::steady_clock::now() - start).count();
+        cout << "Checked " << checked << " of " << layouts.size() << " layouts of " << quadrantName << " in "
+             << seconds << " s.  " << (found ? "A layout disagrees." : "All agree.") << endl;
+        if( found) {
+            writeAssemblyMismatch( cout, walls, quadrants, mismatch);
+        }
+        return found ? -1 : 0;
+    }
+
+    // every random set has the same tiles and sides, so the same layouts
+    makeFuzzQuadrants( seed, 0, walls, quadrants);
+    listQuadrantLayouts( quadrants, layouts);
+    WorkerPool pool;
+    vector< AssemblyTally> tallies( pool.size());
+    atomic< size_t> nextSet( 0);
+    pool.run( [&]( int worker) {
+        AssemblyTally &tally = tallies[ worker];
+        tally.layouts = 0;
+        tally.mismatches = 0;
+        tally.firstSet = (uint64_t)sets;
+        vector< vector< FuzzWall> > setWalls;
+        vector< Quadrant> setQuadrants;
+        AssemblyMismatch setMismatch;
+        size_t begin, end;
+        while( takeChunk( nextSet, (size_t)sets, 1, begin, end)) {
+            makeFuzzQuadrants( seed, begin, setWalls, setQuadrants);
+            if( findAssemblyMismatch( setQuadrants, layouts, tally.layouts, setMismatch)) {
+                tally.mismatches++;
+                tally.firstSet = min( tally.firstSet, (uint64_t)begin);
+            }
+        }
+    });
+    double seconds = chrono::duration< double>( chrono::steady_clock::now() - start).count();
+
+    long checked = 0;
+    long mismatches = 0;
+    uint64_t firstSet = (uint64_t)sets;
+    for( size_t i=0; i<tallies.size(); i++) {
+        checked += tallies[ i].layouts;
+        mismatches += tallies[ i].mismatches;
+        firstSet = min( firstSet, tallies[ i].firstSet);
+    }
+    cout << "Checked " << checked << " layouts of " << sets << " quadrant sets, seed " << seed << ", in "
+         << seconds << " s.  " << mismatches << " sets disagree." << endl;
+    if( mismatches == 0) {
+        return 0;
+    }
+    long unused = 0;
+    makeFuzzQuadrants( seed, firstSet, walls, quadrants);
+    findAssemblyMismatch( quadrants, layouts, unused, mismatch);
+    cout << "First mismatch, in set " << firstSet << ":" << endl;
+    writeAssemblyMismatch( cout, walls, quadrants, mismatch);
+    return -1;
+}//end runAssemblyFuzz()
+
+
+//-------------------------------------------------------------------------------------
+// Benchmarks
+//      RicoRobots -bench
+//      Times fixed, seeded workloads on BOARD_FILE and writes one JSON object to
+//      standard output, so results from different versions can be compared:
+//
+//          {"benchmarks":[{"name":"slide","operations":4000000,"ns_per_op":2.1},
+//                         {"name":"solve_bfs_hard",...,"states_per_sec":1.2e+06},...],
+//           "checksum":123456789,"peak_rss_kb":51200}
+//
+//      slide, canMove and successors time single moves and whole-state expansions,
+//      solve_* time complete solves of easy, medium and hard puzzles picked from
+//      seeded random placements, undo_redo times MoveLog churn, sessions times many
+//      games sharing one board played on every thread at once, replay times checking
+//      random game records on every thread, assemble times putting together layouts
+//      of the board's own quadrants (and fails the bench if the first layout isn't
+//      the board itself), and display_full and render_diff time
+//      drawing a frame (written to a null stream).  The checksum
+//      folds in every result, so the work can't be optimized away, and it changes if
+//      a move or solution changes.
+//
+const long BENCH_MOVES = 4000000;              // single moves timed
+const long BENCH_EXPANSIONS = 1000000;         // whole-state expansions timed
+const long BENCH_LOG_OPERATIONS = 4000000;     // move log operations timed
+const long BENCH_FRAMES = 20000;               // frames drawn
+const int BENCH_SESSIONS = 4096;               // games played at once on one shared board
+const int BENCH_SESSION_MOVES = 1000;          // moves made in each game, with an undo every fourth
+const long BENCH_RECORDS = 200000;             // game records replayed
+const int BENCH_RECORD_MIN_MOVES = 20;         // a random game ends at a new letter after this many moves
+const int BENCH_RECORD_MAX_MOVES = 200;        // and is dropped if it hasn't by this many
+const long BENCH_ASSEMBLIES = 200000;          // layouts assembled from quadrants
+const int BENCH_PUZZLES_PER_LEVEL = 3;         // puzzles in each solve corpus
+const int BENCH_LEVEL_MOVES[ 3] = { 4, 8, 12 }; // solution lengths of easy, medium and hard
+const char *const BENCH_LEVEL_NAMES[ 3] = { "easy", "medium", "hard" };
+const uint64_t BENCH_SEED = 1;
+const uint64_t BENCH_MAX_SAMPLES = 1000;       // placements tried for the corpus, small boards may lack hard puzzles
+
+struct BenchResult {
+    string name;
+    long operations;
+    double nanoseconds;        // total time for all operations
+    long states;               // states expanded, for solves
+};
+
+// Stream buffer that throws away everything written to it
+class NullBuffer : public streambuf {
+protected:
+    int overflow( int c) { return c; }
+    streamsize xsputn( const char *, streamsize count) { return count; }
+};
+
+// Nanoseconds since start
+inline double nanosecondsSince( chrono::steady_clock::time_point start)
+{
+    return chrono::duration< double, nano>( chrono::steady_clock::now() - start).count();
+}
+
+
+//-------------------------------------------------------------------------------------
+// randomRobots() - Put the robots on different random squares
+//
+void randomRobots( RandomGenerator &generator, int robots[ NUMBER_OF_ROBOTS + 1])
+{
+    robots[ 0] = 0;
+    for( int i=1; i<=NUMBER_OF_ROBOTS; i++) {
+        bool taken;
+        do {
+            robots[ i] = randomBelow( generator, BOARD_SIZE);
+            taken = false;
+            for( int j=1; j<i; j++) {
+                taken = taken || (robots[ j] == robots[ i]);
+            }
+        } while( taken);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// runBenchmarks() - Run every benchmark and write the results.  Returns the exit status.
+//
+int runBenchmarks()
+{
+    int numberOfDestinationPieces;
+    readFromFileAndModifyBoard( numberOfDestinationPieces);
+
+    vector< BenchResult> results;
+    uint64_t checksum = 0;
+    RandomGenerator generator;
+    randomSeed( generator, BENCH_SEED, 0);
+
+    // random states and moves to time, made before the clock starts
+    const int STATE_COUNT = 4096;
+    vector< StateKey> keys( STATE_COUNT);
+    vector< unsigned char> moves( STATE_COUNT);
+    for( int i=0; i<STATE_COUNT; i++) {
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        randomRobots( generator, robots);
+        keys[ i] = packRobots( robots);
+        moves[ i] = (unsigned char)randomBelow( generator, MAX_SUCCESSORS);
+    }
+
+    // single slides from the precomputed tables
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( long i=0; i<BENCH_MOVES; i++) {
+        int move = moves[ i & (STATE_COUNT - 1)];
+        checksum += slideRobot( theBoard, keys[ i & (STATE_COUNT - 1)],
+                                move / NUMBER_OF_DIRECTIONS + 1, move % NUMBER_OF_DIRECTIONS);
+    }
+    BenchResult slide = { "slide", BENCH_MOVES, nanosecondsSince( start), 0 };
+    results.push_back( slide);
+
+    // the one-square move rule, on the game's board and robots
+    start = chrono::steady_clock::now();
+    for( long i=0; i<BENCH_MOVES; i++) {
+        int direction = moves[ i & (STATE_COUNT - 1)] % NUMBER_OF_DIRECTIONS;
+        checksum += canMove( i & (BOARD_SIZE - 1), DIRECTION_OFFSETS[ direction], DIRECTION_LETTERS[ direction]);
+    }
+    BenchResult oneSquare = { "canMove", BENCH_MOVES, nanosecondsSince( start), 0 };
+    results.push_back( oneSquare);
+
+    // every move from a state
+    start = chrono::steady_clock::now();
+    for( long i=0; i<BENCH_EXPANSIONS; i++) {
+        StateKey successors[ MAX_SUCCESSORS];
+        unsigned char successorMoves[ MAX_SUCCESSORS];
+        int count = generateSuccessors( theBoard, keys[ i & (STATE_COUNT - 1)], successors, successorMoves);
+        checksum += count + successors[ 0];
+    }
+    BenchResult expansions = { "successors", BENCH_EXPANSIONS, nanosecondsSince( start), BENCH_EXPANSIONS };
+    results.push_back( expansions);
+
+    // pick the solve corpus from seeded placements, with its own scratch memory so
+    // the solves below start from the same state every run
+    vector< GeneratedPuzzle> corpus[ 3];
+    SolverContext *ratingContext = new SolverContext;
+    for( uint64_t sample=1; ((corpus[ 0].size() + corpus[ 1].size() + corpus[ 2].size()) <
+                            (size_t)(3 * BENCH_PUZZLES_PER_LEVEL)) && (sample <= BENCH_MAX_SAMPLES); sample++) {
+        GeneratedPuzzle puzzle;
+        randomSeed( generator, BENCH_SEED, sample);
+        randomRobots( generator, puzzle.robots);
+        unsigned char optimalMoves[ NUMBER_OF_ROBOTS + 1][ NUMBER_OF_LETTERS];
+        rateStartPosition( *ratingContext, theBoard, puzzle.robots, BENCH_LEVEL_MOVES[ 2], optimalMoves);
+        for( int level=0; level<3; level++) {
+            for( int goal=0; (goal < NUMBER_OF_ROBOTS * NUMBER_OF_LETTERS) &&
+                             (corpus[ level].size() < (size_t)BENCH_PUZZLES_PER_LEVEL); goal++) {
+                puzzle.goalRobot = goal / NUMBER_OF_LETTERS + 1;
+                puzzle.destinationLetter = (char)('A' + goal % NUMBER_OF_LETTERS);
+                if( optimalMoves[ puzzle.goalRobot][ goal % NUMBER_OF_LETTERS] == BENCH_LEVEL_MOVES[ level]) {
+                    corpus[ level].push_back( puzzle);
+                    break;      // at most one goal per placement and level
+                }
+            }
+        }
+    }
+    delete ratingContext;
+
+    // time solving the corpus each way.  The IDA* bound table is allocated and
+    // written here, so its 32 MB is not timed as part of the first easy solve.
+    SolverContext context;
+    startBoundGeneration( context);
+    for( int solver=0; solver<2; solver++) {
+        for( int level=0; level<3; level++) {
+            BenchResult solves = { string( solver == 0 ? "solve_bfs_" : "solve_ida_") + BENCH_LEVEL_NAMES[ level],
+                                   (long)corpus[ level].size(), 0, 0 };
+            for( size_t i=0; i<corpus[ level].size(); i++) {
+                const GeneratedPuzzle &puzzle = corpus[ level][ i];
+                int goalPosition = theBoard.targets[ puzzle.destinationLetter - 'A'];
+                vector<SolverMove> solution;
+                start = chrono::steady_clock::now();
+                if( solver == 0) {
+                    solvePuzzle( context, theBoard, puzzle.robots, puzzle.goalRobot, goalPosition,
+                                 DEFAULT_MAX_SOLUTION_MOVES, solution);
+                }
+                else {
+                    solvePuzzleIDA( context, theBoard, puzzle.robots, puzzle.goalRobot, goalPosition,
+                                    DEFAULT_MAX_SOLUTION_MOVES, solution);
+                }
+                solves.nanoseconds += nanosecondsSince( start);
+                solves.states += context.statesExpanded;
+                checksum = checksum * 31 + solution.size();
+            }
+            results.push_back( solves);
+        }
+    }
+
+    // move log churn: a move, then every fourth move undo two and redo one
+    {
+        MoveLog history;
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        Bitboard occupancy;
+        for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+            robots[ i] = theRobots[ i];
+        }
+        occupancy = theOccupancy;
+        long operations = 0;
+        start = chrono::steady_clock::now();
+        for( long i=0; operations<BENCH_LOG_OPERATIONS; i++) {
+            int move = moves[ i & (STATE_COUNT - 1)];
+            int robot = move / NUMBER_OF_DIRECTIONS + 1;
+            int destination = slideRobot( theBoard, packRobots( robots), robot, move % NUMBER_OF_DIRECTIONS);
+            recordMove( history, robot, robots[ robot], destination);
+            moveRobotTo( robots, occupancy, robot, destination);
+            operations++;
+            if( (i & 3) == 3) {
+                undoMove( history, robots, occupancy);
+                undoMove( history, robots, occupancy);
+                redoMove( history, robots, occupancy);
+                operations += 3;
+            }
+        }
+        BenchResult churn = { "undo_redo", operations, nanosecondsSince( start), 0 };
+        results.push_back( churn);
+        checksum += packRobots( robots) + history.current;
+    }
+
+    // many games on one shared board, each advanced by whichever worker takes it.  Each
+    // game's moves depend only on its number, so the checksum doesn't depend on threads.
+    {
+        shared_ptr< const Board> board = make_shared< const Board>( theBoard);
+        vector< Game> games( BENCH_SESSIONS);
+        for( int i=0, letter=0; i<BENCH_SESSIONS; i++) {
+            // letters not on the board are skipped
+            while( !startGame( games[ i], board, theRobots, 1, (char)('A' + letter++ % NUMBER_OF_LETTERS))) {
+            }
+        }
+        WorkerPool pool;
+        atomic< size_t> nextGame( 0);
+        start = chrono::steady_clock::now();
+        pool.run( [&]( int) {
+            size_t begin, end;
+            while( takeChunk( nextGame, games.size(), 16, begin, end)) {
+                for( size_t i=begin; i<end; i++) {
+                    for( int j=0; j<BENCH_SESSION_MOVES; j++) {
+                        int move = moves[ (i * 7 + j) & (STATE_COUNT - 1)];
+                        makeGameMove( games[ i], move / NUMBER_OF_DIRECTIONS + 1, move % NUMBER_OF_DIRECTIONS);
+                        if( (j & 3) == 3) {
+                            undoGameMove( games[ i]);
+                        }
+                    }
+                }
+            }
+        });
+        BenchResult sessions = { "sessions", (long)BENCH_SESSIONS * BENCH_SESSION_MOVES, nanosecondsSince( start), 0 };
+        results.push_back( sessions);
+        for( int i=0; i<BENCH_SESSIONS; i++) {
+            checksum = checksum * 31 + packRobots( games[ i].robots) + goalReached( games[ i]);
+        }
+    }
+
+    // replaying game records.  Each game is random moves from a random start, ended
+    // by the first robot after BENCH_RECORD_MIN_MOVES to stop on a letter it hasn't
+    // stopped on before, which makes that robot and letter its goal.
+    {
+        shared_ptr< const Board> board = make_shared< const Board>( theBoard);
+        uint64_t hash = boardHash( theBoard);
+        signed char letterAt[ BOARD_SIZE];
+        memset( letterAt, -1, sizeof( letterAt));
+        char firstLetter = ' ';
+        for( int letter=NUMBER_OF_LETTERS-1; letter>=0; letter--) {
+            if( theBoard.targets[ letter] >= 0) {
+                letterAt[ theBoard.targets[ letter]] = (signed char)letter;
+                firstLetter = (char)('A' + letter);
+            }
+        }
+        vector< unsigned char> image;
+        Game game;
+        RandomGenerator generator;
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        for( long i=0; i<BENCH_RECORDS; i++) {
+            randomSeed( generator, BENCH_SEED, (uint64_t)i);
+            randomRobots( generator, robots);
+            startGame( game, board, robots, 1, firstLetter);
+            uint32_t letters[ NUMBER_OF_ROBOTS + 1] = { 0 };     // letters each robot has stopped on
+            for( int move=0; move<BENCH_RECORD_MAX_MOVES; move++) {
+                int code = randomBelow( generator, NUMBER_OF_ROBOTS * NUMBER_OF_DIRECTIONS);
+                int robot = code / NUMBER_OF_DIRECTIONS + 1;
+                int from = game.robots[ robot];
+                int to = makeGameMove( game, robot, code % NUMBER_OF_DIRECTIONS);
+                if( (to == from) || (letterAt[ to] < 0) || ((letters[ robot] >> letterAt[ to]) & 1)) {
+                    continue;
+                }
+                letters[ robot] |= 1u << letterAt[ to];
+                if( move + 1 >= BENCH_RECORD_MIN_MOVES) {
+                    game.goalRobot = robot;
+                    game.destinationLetter = (char)('A' + letterAt[ to]);
+                    game.goalPosition = to;
+                    encodeGameRecord( game, hash, image);
+                    break;
+                }
+            }
+        }
+        GameRecordBoards boards;
+        boards[ hash] = &theBoard;
+        WorkerPool pool;
+        long records = 0;
+        long valid = 0;
+        long replayed = 0;
+        vector< GameRecordError> errors;
+        start = chrono::steady_clock::now();
+        checkGameRecords( &image[ 0], image.size(), boards, pool, records, valid, replayed, errors);
+        BenchResult replay = { "replay", replayed, nanosecondsSince( start), 0 };
+        results.push_back( replay);
+        checksum = checksum * 31 + (uint64_t)(records - valid) * 1000003 + (uint64_t)replayed;
+    }
+
+    // assembling layouts of the board's own quadrants.  Layout 0 is the board itself,
+    // so assembling it must give back the board exactly.
+    {
+        vector< Quadrant> quadrants;
+        vector< QuadrantLayout> layouts;
+        quadrantsOfBoard( theBoard, quadrants);
+        listQuadrantLayouts( quadrants, layouts);
+        Board board;
+        assembleLayout( quadrants, layouts[ 0], board);
+        bool same = (memcmp( board.slideStop, theBoard.slideStop, sizeof( board.slideStop)) == 0) &&
+                    (memcmp( board.targets, theBoard.targets, sizeof( board.targets)) == 0);
+        for( int direction=0; direction<NUMBER_OF_DIRECTIONS; direction++) {
+            for( int word=0; word<BITBOARD_WORDS; word++) {
+                same = same && (board.walls[ direction].word[ word] == theBoard.walls[ direction].word[ word]);
+            }
+        }
+        start = chrono::steady_clock::now();
+        for( long i=0; i<BENCH_ASSEMBLIES; i++) {
+            assembleLayout( quadrants, layouts[ i % layouts.size()], board);
+            checksum += board.slideStop[ i & (BOARD_SIZE - 1)][ i & 3];
+        }
+        BenchResult assemble = { "assemble", BENCH_ASSEMBLIES, nanosecondsSince( start), 0 };
+        results.push_back( assemble);
+        checksum = checksum * 31 + same;
+        if( !same) {
+            cout << "*** Error, assembling the board's own quadrants did not give the board back.  Exiting..." << endl;
+            return -1;
+        }
+    }
+
+    // drawing frames, with the output thrown away
+    {
+        NullBuffer nullBuffer;
+        streambuf *screen = cout.rdbuf( &nullBuffer);
+        int robots[ NUMBER_OF_ROBOTS + 1];
+        for( int i=0; i<=NUMBER_OF_ROBOTS; i++) {
+            robots[ i] = theRobots[ i];
+        }
+        start = chrono::steady_clock::now();
+        for( long i=0; i<BENCH_FRAMES; i++) {
+            displayBoard( 2, 'M', theBoard, robots);
+        }
+        BenchResult full = { "display_full", BENCH_FRAMES, nanosecondsSince( start), 0 };
+
+        // one robot sliding back and forth along its row, one square per frame
+        Renderer renderer;
+        renderer.framesPerSecond = 0;
+        int column = robots[ 1] % BOARD_EDGE;
+        start = chrono::steady_clock::now();
+        for( long i=0; i<BENCH_FRAMES; i++) {
+            int step = (int)(i % (2 * (BOARD_EDGE - 1)));
+            int newColumn = (step < BOARD_EDGE - 1) ? step : 2 * (BOARD_EDGE - 1) - step;
+            robots[ 1] += newColumn - column;
+            column = newColumn;
+            renderBoard( renderer, 2, 'M', theBoard, robots);
+        }
+        BenchResult diff = { "render_diff", BENCH_FRAMES, nanosecondsSince( start), 0 };
+        cout.rdbuf( screen);
+        results.push_back( full);
+        results.push_back( diff);
+    }
+
+    cout << "{\"benchmarks\":[";
+    for( size_t i=0; i<results.size(); i++) {
+        const BenchResult &result = results[ i];
+        cout << (i > 0 ? "," : "") << "{\"name\":\"" << result.name << "\",\"operations\":" << result.operations
+             << ",\"ns_per_op\":" << (result.operations > 0 ? result.nanoseconds / result.operations : 0.0);
+        if( result.states > 0) {
+            cout << ",\"states\":" << result.states << ",\"states_per_sec\":" << result.states * 1e9 / result.nanoseconds;
+        }
+        cout << "}";
+    }
+    cout << "],\"checksum\":" << checksum << ",\"peak_rss_kb\":" << peakMemoryKilobytes() << "}" << endl;
+    return 0;
+}//end runBenchmarks()
+
+
+//-------------------------------------------------------------------------------------
+// displaySolution() - Display the moves found by the solver
+//
+void displaySolution( int goalRobot,                      // robot that needs to reach destination
+                      char destinationLetter,             // the destination letter
+                      const vector<SolverMove> &solution) // moves found by the solver
+{
+    cout << "Robot " << goalRobot << " reaches square " << destinationLetter << " in "
+         << solution.size() << " moves:" << endl;
+    for( size_t i=0; i<solution.size(); i++) {
+        cout << "  " << (i+1) << ". " << solution[ i].robot << " " << solution[ i].direction << endl;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// displayDifficultyTable()
+//      Display the fewest moves each robot needs to reach each letter, as found by
+//      rateStartPosition().  Goals that take more than maxMoves are shown as '-'.
+//
+void displayDifficultyTable( const Board &board,     // board the table is for
+                             const unsigned char optimalMoves[ NUMBER_OF_ROBOTS + 1][ NUMBER_OF_LETTERS],
+                             int maxMoves)           // deepest search made
+{
+    cout << "Fewest moves for each robot to reach each letter ('-' is more than " << maxMoves << "):" << endl;
+    cout << "        ";
+    for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+        if( board.targets[ letter] >= 0) {
+            cout << "  " << (char)('A' + letter);
+        }
+    }
+    cout << endl;
+    for( int robot=1; robot<=NUMBER_OF_ROBOTS; robot++) {
+        cout << "Robot " << robot << " ";
+        for( int letter=0; letter<NUMBER_OF_LETTERS; letter++) {
+            if( board.targets[ letter] < 0) {
+                continue;
+            }
+            if( optimalMoves[ robot][ letter] == UNREACHABLE) {
+                cout << "  -";
+            }
+            else {
+                cout << (optimalMoves[ robot][ letter] < 10 ? "  " : " ") << (int)optimalMoves[ robot][ letter];
+            }
+        }
+        cout << endl;
+    }
+}//end displayDifficultyTable()
+
+
+//-------------------------------------------------------------------------------------
+// main() - main part of program, that drives everything else
+//
+int main( int argc, char *argv[])
+{
+    // variable declarations
+    int goalRobot;          // the robot that needs to reach the goal                                                     
     char destinationLetter;  // the goal letter
     int numberOfDestinationPieces;  // Number of destination pieces.  Value
                                     //    comes from the data file
@@ -591,6 +7345,407 @@ int main()
               // Only do this ONCE in your program!
               //use srand( time(0)); to give different values each time.
 
+    // Compile mode:  RicoRobots -compile pack.rrb board1.txt [board2.txt ...]
+    // Writes the boards to a board pack, see compileBoardPack().
+    if( (argc > 1) && (strcmp( argv[ 1], "-compile") == 0)) {
+        if( argc < 4) {
+            cout << "Usage: RicoRobots -compile pack.rrb board1.txt [board2.txt ...]" << endl;
+            return -1;
+        }
+        return compileBoardPack( argv[ 2], argv + 3, argc - 3);
+    }
+
+    // Assemble mode:  RicoRobots -assemble quadrants.txt pack.rrb
+    // Writes every layout of the quadrants to a board pack, see assembleQuadrants().
+    if( (argc > 1) && (strcmp( argv[ 1], "-assemble") == 0)) {
+        if( argc != 4) {
+            cout << "Usage: RicoRobots -assemble quadrants.txt pack.rrb" << endl;
+            return -1;
+        }
+        return assembleQuadrants( argv[ 2], argv[ 3]);
+    }
+
+    // Benchmark mode:  RicoRobots -bench
+    // Times fixed workloads and writes the results as JSON, see runBenchmarks().
+    if( (argc > 1) && (strcmp( argv[ 1], "-bench") == 0)) {
+        return runBenchmarks();
+    }
+
+    // Generator mode:  RicoRobots -generate moves count [-seed n] [-samples n] [-pack file index]
+    // Writes puzzles with a shortest solution of exactly moves, see generatePuzzles().
+    // With -pack file all, count puzzles are written for every board of the pack, such
+    // as every layout from -assemble, all as one batch file.
+    if( (argc > 1) && (strcmp( argv[ 1], "-generate") == 0)) {
+        if( argc < 4) {
+            cout << "Usage: RicoRobots -generate moves count [-seed n] [-samples n] [-pack file index|all]" << endl;
+            return -1;
+        }
+        int moves = atoi( argv[ 2]);
+        long count = atol( argv[ 3]);
+        uint64_t seed = 1;
+        uint64_t samples = 0;          // 0 for the default, from count
+        string packLine = string( "pack ") + BOARD_CACHE_FILE + " 0";
+        BoardPack pack;
+        const BoardRecord *record = NULL;
+        const char *packName = NULL;
+        for( int i=4; i<argc; i++) {
+            if( (strcmp( argv[ i], "-seed") == 0) && (i+1 < argc)) {
+                seed = strtoull( argv[ ++i], NULL, 10);
+            }
+            else if( (strcmp( argv[ i], "-samples") == 0) && (i+1 < argc)) {
+                samples = strtoull( argv[ ++i], NULL, 10);
+                if( samples == 0) {
+                    cout << "Samples must be at least 1.  Exiting..." << endl;
+                    return -1;
+                }
+            }
+            else if( (strcmp( argv[ i], "-pack") == 0) && (i+2 < argc)) {
+                bool allBoards = (strcmp( argv[ i+2], "all") == 0);
+                if( !pack.open( argv[ i+1]) || (allBoards && (pack.size() == 0)) ||
+                    (!allBoards && ((record = pack.record( (uint32_t)atol( argv[ i+2]))) == NULL))) {
+                    cout << "Board " << argv[ i+2] << " of pack " << argv[ i+1] << " could not be loaded.  Exiting..." << endl;
+                    return -1;
+                }
+                packName = allBoards ? argv[ i+1] : NULL;
+                packLine = string( "pack ") + argv[ i+1] + " " + argv[ i+2];
+                i += 2;
+            }
+            else {
+                cout << "Unknown option " << argv[ i] << ".  Exiting..." << endl;
+                return -1;
+            }
+        }
+        if( (moves < 1) || (moves > DEFAULT_MAX_SOLUTION_MOVES) || (count < 1)) {
+            cout << "Moves must be 1 to " << DEFAULT_MAX_SOLUTION_MOVES << ", and count at least 1.  Exiting..." << endl;
+            return -1;
+        }
+        if( samples == 0) {
+            samples = (uint64_t)count * GENERATOR_DEFAULT_SAMPLES_PER_PUZZLE;
+        }
+        if( packName != NULL) {
+            for( uint32_t index=0; index<pack.size(); index++) {
+                if( (record = pack.record( index)) == NULL) {
+                    cout << "Board " << index << " of pack " << packName << " could not be loaded.  Exiting..." << endl;
+                    return -1;
+                }
+                int status = generatePuzzles( record->board, string( "pack ") + packName + " " + to_string( index),
+                                              moves, count, seed, samples);
+                if( status != 0) {
+                    return status;
+                }
+            }
+            return 0;
+        }
+        if( record == NULL) {
+            readFromFileAndModifyBoard( numberOfDestinationPieces);     // also writes board.rrb
+        }
+        return generatePuzzles( record ? record->board : theBoard, packLine, moves, count, seed, samples);
+    }
+
+    // Fuzz mode:  RicoRobots -fuzz [comparisons] [-seed n]
+    //            RicoRobots -fuzz -assembly [sets | quadrants.txt] [-seed n]
+    // Compares the fast move code with the one-square rule on random boards, see
+    // runFuzz(), or assembled layouts with compiled ones, see runAssemblyFuzz().
+    if( (argc > 1) && (strcmp( argv[ 1], "-fuzz") == 0)) {
+        long count = 0;                // comparisons or sets, 0 for the default
+        uint64_t seed = 1;
+        bool assembly = false;
+        const char *quadrantName = NULL;
+        for( int i=2; i<argc; i++) {
+            if( (strcmp( argv[ i], "-seed") == 0) && (i+1 < argc)) {
+                seed = strtoull( argv[ ++i], NULL, 10);
+            }
+            else if( strcmp( argv[ i], "-assembly") == 0) {
+                assembly = true;
+            }
+            else if( isdigit( argv[ i][ 0])) {
+                count = atol( argv[ i]);
+                if( count < 1) {
+                    cout << "There must be at least 1 comparison or set.  Exiting..." << endl;
+                    return -1;
+                }
+            }
+            else if( assembly && (argv[ i][ 0] != '-')) {
+                quadrantName = argv[ i];
+            }
+            else {
+                cout << "Unknown option " << argv[ i] << ".  Exiting..." << endl;
+                return -1;
+            }
+        }
+        if( assembly) {
+            return runAssemblyFuzz( (count > 0) ? count : FUZZ_DEFAULT_QUADRANT_SETS, seed, quadrantName);
+        }
+        return runFuzz( (count > 0) ? count : FUZZ_DEFAULT_COMPARISONS, seed);
+    }
+
+    // Rating mode:  RicoRobots -rate [maxMoves]
+    // Prints how many moves every robot needs to reach every letter from the starting
+    // position in board.txt, all from one breadth-first search (see rateStartPosition()).
+    if( (argc > 1) && (strcmp( argv[ 1], "-rate") == 0)) {
+        int maxMoves = (argc > 2) ? atoi( argv[ 2]) : DEFAULT_RATE_MOVES;
+        if( (maxMoves < 1) || (maxMoves > DEFAULT_MAX_SOLUTION_MOVES)) {
+            cout << "Moves must be 1 to " << DEFAULT_MAX_SOLUTION_MOVES << ".  Exiting..." << endl;
+            return -1;
+        }
+        readFromFileAndModifyBoard( numberOfDestinationPieces);
+        SolverContext context;
+        unsigned char optimalMoves[ NUMBER_OF_ROBOTS + 1][ NUMBER_OF_LETTERS];
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        rateStartPosition( context, theBoard, theRobots, maxMoves, optimalMoves);
+        double milliseconds = microsecondsSince( start) / 1000;
+        displayDifficultyTable( theBoard, optimalMoves, maxMoves);
+        cout << "States expanded: " << context.statesExpanded << " in " << milliseconds << " ms" << endl;
+        return 0;
+    }
+
+    // Batch mode:  RicoRobots -batch [file] [-ida] [-cache cachefile]
+    // Solves every puzzle in the file (or standard input), see runBatch().
+    if( (argc > 1) && (strcmp( argv[ 1], "-batch") == 0)) {
+        bool useIda = false;
+        const char *fileName = NULL;
+        const char *cacheFileName = NULL;
+        for( int i=2; i<argc; i++) {
+            if( strcmp( argv[ i], "-ida") == 0) {
+                useIda = true;
+            }
+            else if( (strcmp( argv[ i], "-cache") == 0) && (i+1 < argc)) {
+                cacheFileName = argv[ ++i];
+            }
+            else {
+                fileName = argv[ i];
+            }
+        }
+        SolutionCache cache;
+        if( (cacheFileName != NULL) && !cache.open( cacheFileName)) {
+            cout << "Solution cache " << cacheFileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        if( fileName == NULL) {
+            return runBatch( cin, useIda, cacheFileName ? &cache : NULL);
+        }
+        ifstream batchFile( fileName);
+        if( batchFile.fail()) {
+            cout << "Batch file " << fileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        return runBatch( batchFile, useIda, cacheFileName ? &cache : NULL);
+    }
+
+    // Validate mode:  RicoRobots -validate records.rrg [more.rrg ...] [-pack pack.rrb ...]
+    // Replays every game in the record files, see validateGameRecords().  The games
+    // may be played on the board from board.txt, or any board of the packs.
+    if( (argc > 1) && (strcmp( argv[ 1], "-validate") == 0)) {
+        vector< char *> fileNames;
+        vector< unique_ptr< BoardPack> > packs;
+        for( int i=2; i<argc; i++) {
+            if( (strcmp( argv[ i], "-pack") == 0) && (i+1 < argc)) {
+                packs.push_back( unique_ptr< BoardPack>( new BoardPack));
+                if( !packs.back()->open( argv[ ++i])) {
+                    cout << "Board pack " << argv[ i] << " could not be opened.  Exiting..." << endl;
+                    return -1;
+                }
+            }
+            else {
+                fileNames.push_back( argv[ i]);
+            }
+        }
+        if( fileNames.empty()) {
+            cout << "Usage: RicoRobots -validate records.rrg [more.rrg ...] [-pack pack.rrb ...]" << endl;
+            return -1;
+        }
+        readFromFileAndModifyBoard( numberOfDestinationPieces);
+        GameRecordBoards boards;
+        boards[ boardHash( theBoard)] = &theBoard;
+        for( size_t i=0; i<packs.size(); i++) {
+            for( uint32_t index=0; index<packs[ i]->size(); index++) {
+                const BoardRecord *record = packs[ i]->record( index);
+                if( record != NULL) {
+                    boards[ boardHash( record->board)] = &record->board;
+                }
+            }
+        }
+        return validateGameRecords( &fileNames[ 0], (int)fileNames.size(), boards);
+    }
+
+    // Server mode:  RicoRobots -serve [port | socket path] [-ida] [-cache cachefile]
+    // Answers solve, hint and other requests over a socket, see runServer().
+    if( (argc > 1) && (strcmp( argv[ 1], "-serve") == 0)) {
+        bool useIda = false;
+        string address = to_string( DEFAULT_SERVER_PORT);
+        const char *cacheFileName = NULL;
+        for( int i=2; i<argc; i++) {
+            if( strcmp( argv[ i], "-ida") == 0) {
+                useIda = true;
+            }
+            else if( (strcmp( argv[ i], "-cache") == 0) && (i+1 < argc)) {
+                cacheFileName = argv[ ++i];
+            }
+            else {
+                address = argv[ i];
+            }
+        }
+        SolutionCache cache;
+        if( (cacheFileName != NULL) && !cache.open( cacheFileName)) {
+            cout << "Solution cache " << cacheFileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        return runServer( address, useIda, cacheFileName ? &cache : NULL);
+    }
+
+    // Solver modes:  RicoRobots -solve [robot letter]    (breadth-first search)
+    //                RicoRobots -ida [robot letter]      (iterative-deepening A*)
+    //                RicoRobots -parallel [robot letter] (breadth-first search on all cores)
+    //                RicoRobots -compact [robot letter]  (breadth-first search in 2 bits per state)
+    //                RicoRobots -external [robot letter] [-dir directory]  (breadth-first search on disk)
+    // Prints a shortest solution instead of playing the game.  -stats file and -trace
+    // file write the search statistics as JSON or as Chrome trace events.  -cache file
+    // looks the puzzle up in a solution cache first.
+    if( (argc > 1) && ((strcmp( argv[ 1], "-solve") == 0) || (strcmp( argv[ 1], "-ida") == 0) ||
+                       (strcmp( argv[ 1], "-parallel") == 0) || (strcmp( argv[ 1], "-compact") == 0) ||
+                       (strcmp( argv[ 1], "-external") == 0))) {
+        readFromFileAndModifyBoard( numberOfDestinationPieces);
+        goalRobot = 2;                // same default goal as the game below
+        destinationLetter = 'M';
+        int firstOption = 2;
+        if( (argc > 3) && (argv[ 2][ 0] != '-')) {
+            goalRobot = atoi( argv[ 2]);
+            destinationLetter = toupper( argv[ 3][ 0]);
+            firstOption = 4;
+        }
+        if( (goalRobot < 1) || (goalRobot > NUMBER_OF_ROBOTS)) {
+            cout << "Invalid robot value " << argv[ 2] << ".  Exiting..." << endl;
+            return -1;
+        }
+        const char *statsFileName = NULL;
+        const char *traceFileName = NULL;
+        const char *cacheFileName = NULL;
+        const char *directory = ".";
+        for( int i=firstOption; i<argc; i++) {
+            if( (strcmp( argv[ i], "-cache") == 0) && (i+1 < argc)) {
+                cacheFileName = argv[ ++i];
+            }
+            else if( (strcmp( argv[ i], "-dir") == 0) && (i+1 < argc)) {
+                directory = argv[ ++i];
+            }
+            else if( (strcmp( argv[ i], "-stats") == 0) && (i+1 < argc)) {
+                statsFileName = argv[ ++i];
+            }
+            else if( (strcmp( argv[ i], "-trace") == 0) && (i+1 < argc)) {
+                traceFileName = argv[ ++i];
+            }
+            else {
+                cout << "Unknown option " << argv[ i] << ".  Exiting..." << endl;
+                return -1;
+            }
+        }
+
+        SolverContext context;
+        context.collectStats = (statsFileName != NULL) || (traceFileName != NULL);
+        vector<SolverMove> solution;
+        bool solved = false;
+        SolutionCache cache;
+        if( (cacheFileName != NULL) && !cache.open( cacheFileName)) {
+            cout << "Solution cache " << cacheFileName << " could not be opened.  Exiting..." << endl;
+            return -1;
+        }
+        int goalPosition = getGoalPosition( destinationLetter);
+        bool cached = (cacheFileName != NULL) &&
+                      cache.lookup( theBoard, theRobots, goalRobot, goalPosition, DEFAULT_MAX_SOLUTION_MOVES,
+                                    solved, solution);
+        if( cached) {
+            cout << "Found in the solution cache." << endl;
+        }
+        else if( strcmp( argv[ 1], "-ida") == 0) {
+            solved = solvePuzzleIDA( context, theBoard, theRobots, goalRobot, goalPosition,
+                                     DEFAULT_MAX_SOLUTION_MOVES, solution);
+        }
+        else if( strcmp( argv[ 1], "-parallel") == 0) {
+            WorkerPool pool;
+            ParallelSolverContext parallelContext;
+            parallelContext.collectStats = context.collectStats;
+            solved = solvePuzzleParallel( parallelContext, pool, theBoard, theRobots, goalRobot,
+                                          goalPosition, DEFAULT_MAX_SOLUTION_MOVES, solution);
+            context.statesExpanded = parallelContext.statesExpanded;
+            context.stats = parallelContext.stats;
+        }
+        else if( strcmp( argv[ 1], "-compact") == 0) {
+            if( !COMPACT_SOLVER_AVAILABLE) {
+                cout << "The compact search needs a build with 4 robots or fewer.  Exiting..." << endl;
+                return -1;
+            }
+            CompactSolverContext compactContext;
+            compactContext.collectStats = context.collectStats;
+            solved = solvePuzzleCompact( compactContext, theBoard, theRobots, goalRobot, goalPosition,
+                                         DEFAULT_MAX_SOLUTION_MOVES, solution);
+            context.statesExpanded = compactContext.statesExpanded;
+            context.stats = compactContext.stats;
+            cout << "Depth marks: " << compactContext.pagesInUse.size() << " pages, "
+                 << compactContext.pagesInUse.size() * COMPACT_PAGE_WORDS * sizeof( uint64_t) / 1024 << " KB" << endl;
+        }
+        else if( strcmp( argv[ 1], "-external") == 0) {
+            ExternalSolverContext externalContext;
+            externalContext.directory = directory;
+            externalContext.progress = &cout;
+            externalContext.collectStats = context.collectStats;
+            solved = solvePuzzleExternal( externalContext, theBoard, theRobots, goalRobot, goalPosition,
+                                          DEFAULT_MAX_SOLUTION_MOVES, solution);
+            context.statesExpanded = externalContext.statesExpanded;
+            context.stats = externalContext.stats;
+        }
+        else {
+            solved = solvePuzzle( context, theBoard, theRobots, goalRobot, goalPosition,
+                                  DEFAULT_MAX_SOLUTION_MOVES, solution);
+        }
+        if( (cacheFileName != NULL) && !cached) {
+            cache.store( theBoard, theRobots, goalRobot, goalPosition, DEFAULT_MAX_SOLUTION_MOVES, solved, solution);
+        }
+        if( solved) {
+            displaySolution( goalRobot, destinationLetter, solution);
+        }
+        else {
+            cout << "No solution of " << DEFAULT_MAX_SOLUTION_MOVES << " moves or less." << endl;
+        }
+        cout << "States expanded: " << context.statesExpanded << endl;
+        if( context.collectStats && !SOLVER_STATS_ENABLED) {
+            cout << "Solver statistics were left out of this build." << endl;
+        }
+        else if( context.collectStats && cached) {
+            cout << "No search was made, so no solver statistics were written." << endl;
+        }
+        else if( context.collectStats) {
+            if( statsFileName != NULL) {
+                ofstream statsFile( statsFileName);
+                writeStatsJson( statsFile, context.stats);
+            }
+            if( traceFileName != NULL) {
+                ofstream traceFile( traceFileName);
+                writeStatsTrace( traceFile, context.stats);
+            }
+        }
+        return 0;
+    }
+
+    // Game options:  RicoRobots [-fps framesPerSecond] [-noanimate] [-record file]
+    // -record adds the game to a game record file when the goal is reached.
+    Renderer renderer;
+    const char *recordFileName = NULL;
+    for( int i=1; i<argc; i++) {
+        if( (strcmp( argv[ i], "-fps") == 0) && (i+1 < argc)) {
+            renderer.framesPerSecond = atoi( argv[ ++i]);
+        }
+        else if( (strcmp( argv[ i], "-record") == 0) && (i+1 < argc)) {
+            recordFileName = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "-noanimate") == 0) {
+            renderer.animate = false;
+        }
+        else {
+            cout << "Unknown option " << argv[ i] << ".  Exiting..." << endl;
+            return -1;
+        }
+    }
+
     system("cls");        // clear the screen
     
     // Display Instructions
@@ -609,13 +7764,10 @@ int main()
             "would move the #1 robot as far up as it can go. \n" <<
             "The first letter of input is the robot number (1 - 4), \n" <<
             "and the second letter is the direction (L=left, U=up, R=right, D=down) \n" <<
-            "Enter x to exit.  Enter u to undo a move.  Have fun!\n" <<   
+            "Enter x to exit.  Enter u to undo a move, r to redo it, h for a hint.  Have fun!\n" <<   
             "\n";
 
-    // create the board, initializing all pieces to their default settings
-    createBoard();                // initialize the global theBoard array
-
-    // read from the datafile and modify the board accordingly
+    // read the board from the datafile, or its compiled cache
     readFromFileAndModifyBoard( numberOfDestinationPieces);
 
     // choose a random robot and random destination
@@ -625,8 +7777,10 @@ int main()
     goalRobot = 2;
     destinationLetter = 'M';
 
-    // play the game
-    playGame( goalRobot, destinationLetter);    // you'll need to pass some parameters...
+    // play the game, on a copy of the board that the game shares
+    Game game;
+    startGame( game, make_shared< const Board>( theBoard), theRobots, goalRobot, destinationLetter);
+    playGame( game, renderer, recordFileName);
 
     // pause output
     cout << "Press enter to exit program ..." << endl << endl;